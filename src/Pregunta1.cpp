@@ -13,6 +13,13 @@
 #include <stdlib.h>
 #include <math.h>
 #include <cstdlib>
+
+#include "headless.cpp"
+#include "sdf.cpp"
+// Con -DSCENE_MODULE solo queda la escena, para ./build/gallery (scenemodule.cpp)
+#include "scenemodule.h"
+#include <map>
+#include <vector>
 #define PI 3.141592653589793f
 
 
@@ -20,6 +27,52 @@ float blanco[3]       = {1, 1, 1},
       negro[3]        = {0,0,0};
 
 
+// Malla del circulo unitario, una por cada numero de segmentos.
+// El relleno y el contorno comparten el mismo buffer de vertices; el modo
+// estrella (op != 0) usa un buffer de indices borde, centro, borde, centro...
+typedef struct {
+    GLuint vertices;  // segments puntos del borde + el centro al final
+    GLuint starIndices;
+    GLsizei starCount;
+} UnitMesh;
+
+std::map<int, UnitMesh> unitMeshes;
+
+const UnitMesh& getUnitMesh(int segments) {
+    std::map<int, UnitMesh>::iterator it = unitMeshes.find(segments);
+    if (it != unitMeshes.end()) {
+        return it->second;
+    }
+
+    std::vector<GLfloat> rim(2 * (segments + 1));
+    for (int i = 0; i < segments; ++i) {
+        float theta = ((float)i / (float)segments) * (2.0f * PI);
+        rim[2 * i] = cosf(theta);
+        rim[2 * i + 1] = sinf(theta);
+    }
+    rim[2 * segments] = 0;
+    rim[2 * segments + 1] = 0;
+
+    std::vector<GLuint> star(2 * segments);
+    for (int i = 0; i < segments; ++i) {
+        star[2 * i] = i;
+        star[2 * i + 1] = segments;
+    }
+
+    UnitMesh mesh;
+    mesh.starCount = (GLsizei)star.size();
+    glGenBuffers(1, &mesh.vertices);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.vertices);
+    glBufferData(GL_ARRAY_BUFFER, rim.size() * sizeof(GLfloat), rim.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glGenBuffers(1, &mesh.starIndices);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.starIndices);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, star.size() * sizeof(GLuint), star.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    return unitMeshes[segments] = mesh;
+}
+
 void drawPolygon(
     float x, float y,                       
     float radiusX, float radiusY,                                   
@@ -29,54 +82,47 @@ void drawPolygon(
     float pivotX = 0, float pivotY = 0,               
     float orbitAngleRad = 0) {
 
-    glColor3fv(RGB1);
-    glBegin(GL_POLYGON);
-    float cosOrbit = cosf(orbitAngleRad);
-    float sinOrbit = sinf(orbitAngleRad);
-
-    for (int i = 0; i < segments; ++i) {
-        float base_theta = ((float)i / (float)segments) * (2.0f * PI);
-        
-        float cx = radiusX * cosf(base_theta);
-        float cy = radiusY * sinf(base_theta);
-        
-        float relativePivotX = (x + cx) - pivotX;
-        float relativePivotY = (y + cy) - pivotY;
-        
-        float x_rotated = relativePivotX * cosOrbit - relativePivotY * sinOrbit;
-        float y_rotated = relativePivotX * sinOrbit + relativePivotY * cosOrbit;
-        
-        
-        glVertex2f(x_rotated + pivotX, y_rotated + pivotY);
-        if(op!=0){
-             glVertex2f(x, y);
-            }
+    // Elipse redonda: un solo quad con el shader SDF (relleno y contorno)
+    if (op == 0 && segments >= SDF_MIN_SEGMENTS && sdfAvailable()) {
+        glPushMatrix();
+        glTranslatef(pivotX, pivotY, 0);
+        glRotatef(orbitAngleRad * 180.0f / PI, 0, 0, 1);
+        drawSdfEllipse(x - pivotX, y - pivotY, radiusX, radiusY, RGB1);
+        drawSdfEllipse(x - pivotX, y - pivotY, radiusX, radiusY, RGB2, 1.0f);
+        glPopMatrix();
+        return;
     }
-    glEnd();
 
-    glColor3fv(RGB2);
-    glBegin(GL_LINE_LOOP);
-    for (int i = 0; i < segments; ++i) {
-        float base_theta = ((float)i / (float)segments) * (2.0f * PI);
-        
-        float cx = radiusX * cosf(base_theta);
-        float cy = radiusY * sinf(base_theta);
-        
-        float relativePivotX = (x + cx) - pivotX;
-        float relativePivotY = (y + cy) - pivotY;
-        
-        float x_rotated = relativePivotX * cosOrbit - relativePivotY * sinOrbit;
-        float y_rotated = relativePivotX * sinOrbit + relativePivotY * cosOrbit;
-        
-        
-        glVertex2f(x_rotated + pivotX, y_rotated + pivotY);
-        if(op!=0){
-             glVertex2f(x, y);
-            }
+    const UnitMesh& mesh = getUnitMesh(segments);
+
+    // Elipse en (x, y) girada orbitAngleRad alrededor del pivote
+    glPushMatrix();
+    glTranslatef(pivotX, pivotY, 0);
+    glRotatef(orbitAngleRad * 180.0f / PI, 0, 0, 1);
+    glTranslatef(x - pivotX, y - pivotY, 0);
+    glScalef(radiusX, radiusY, 1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.vertices);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 0, 0);
+
+    if (op != 0) {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.starIndices);
+        glColor3fv(RGB1);
+        glDrawElements(GL_POLYGON, mesh.starCount, GL_UNSIGNED_INT, 0);
+        glColor3fv(RGB2);
+        glDrawElements(GL_LINE_LOOP, mesh.starCount, GL_UNSIGNED_INT, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    } else {
+        glColor3fv(RGB1);
+        glDrawArrays(GL_POLYGON, 0, segments);
+        glColor3fv(RGB2);
+        glDrawArrays(GL_LINE_LOOP, 0, segments);
     }
 
-
-    glEnd();
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glPopMatrix();
 }
 
 void polygon(float x, float y, float r, float n,float *RGB, GLenum modo){
@@ -124,6 +170,11 @@ void drawRingSector(
     float *RGB1,
     int segments = 300) 
 {
+    if (segments >= SDF_MIN_SEGMENTS && sdfAvailable()) {
+        drawSdfEllipse(cx, cy, radius_outer, radius_outer, RGB1, 0, t1, t2, radius_inner / radius_outer);
+        return;
+    }
+
     glColor3fv(RGB1);
     glBegin(GL_TRIANGLE_STRIP);
     for (int i = 0; i <= segments; i++) {
@@ -143,11 +194,13 @@ void drawRingSector(
 
 
 
-void display(void) {
-    glClearColor(1, 1, 1, 1);  
-    glClear(GL_COLOR_BUFFER_BIT);
+void drawShape() {
+    // Colores con glColor3fv: el que conoce la cache de estado (glstate.cpp) vuelve al terminar.
+    // Lineas de 1 pixel sin suavizar, como las deja inicio(), tambien dentro de ./build/gallery
+    glPushAttrib(GL_CURRENT_BIT | GL_ENABLE_BIT | GL_LINE_BIT);
+    glDisable(GL_LINE_SMOOTH);
+    glLineWidth(1.0f);
 
-   
     drawPolygon(0,0,6,6,negro,negro,4,0,0,0,PI/4);
     drawPolygon(0,0,5.65,5.65,blanco,negro,4,0,0,0,PI/4);
 
@@ -186,10 +239,21 @@ for(int i =0; i<5; i++){
 
 }
 
+    glPopAttrib();
+}
 
 
+#ifdef SCENE_MODULE
+// Vista como en inicio()
+SCENE_EXPORT const float sceneViewExtent = 5;
+#else
+void display(void) {
+    glClearColor(1, 1, 1, 1);  
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    drawShape();
 
-    glutSwapBuffers();  
+    presentFrame();  
 }
 
 
@@ -203,6 +267,11 @@ void inicio()
 
 int main(int argc, char *argv[])
 {
+    HeadlessOptions headless;
+    if (parseHeadlessArgs(argc, argv, headless)) {
+        return runHeadless(headless, inicio, display, NULL);
+    }
+
     glutInit(&argc, argv); 
     glutInitWindowSize(800,800);
     glutInitWindowPosition(500,10);
@@ -215,4 +284,5 @@ int main(int argc, char *argv[])
     glutMainLoop();
 
     return EXIT_SUCCESS; 
-}
\ No newline at end of file
+}
+#endif // SCENE_MODULE
@@ -13,8 +13,14 @@
 #include <stdlib.h>
 #include <math.h>
 #include <cstdlib>
+
+#include "headless.cpp"
 #define PI 3.141592653589793f
 
+#include "disks.cpp"
+// Con -DSCENE_MODULE solo queda la escena, para ./build/gallery (scenemodule.cpp)
+#include "scenemodule.h"
+
 
 
 
@@ -22,17 +28,11 @@ float blanco[3]       = {1, 1, 1},
       negro[3]        = {0,0,0};
 
 
-void polygon(float x, float y, float r, float n,float *RGB, GLenum MODO){
+// Todos los circulos de la escena, generados una vez en inicio()
+DiskBatch escena = {};
 
-    glColor3fv(RGB);
-    glBegin(MODO);
-        float angulo = 2 * M_PI / n;
-        for (int i = 0; i < n; i++) {
-            float vx = x + r * cos(i * angulo);
-            float vy = y + r * sin(i * angulo);
-            glVertex2f(vx, vy);
-        }
-    glEnd();
+void polygon(float x, float y, float r, float n,float *RGB, GLenum MODO){
+    addDisk(escena, x, y, r, (int)n, RGB, MODO == GL_POLYGON ? GL_TRIANGLE_FAN : MODO);
 }
 
 
@@ -65,10 +65,7 @@ void elipse(
 
 
 
-void display(void) {
-    glClearColor(1, 1, 1, 1);  
-    glClear(GL_COLOR_BUFFER_BIT);
-
+void construirEscena() {
     polygon(0,0,4.75,100,negro,GL_LINE_LOOP);
     polygon(0,0,4.5,100,negro,GL_LINE_LOOP);
 
@@ -108,9 +105,33 @@ void display(void) {
         polygon(x,y,0.15,100,negro,GL_LINE_LOOP);
 
     }
-    
+}
+
+
+void drawShape() {
+    // Lineas sin suavizar, como las deja inicio(), tambien dentro de ./build/gallery
+    glPushAttrib(GL_ENABLE_BIT);
+    glDisable(GL_LINE_SMOOTH);
+    drawDiskBatch(escena);
+    glPopAttrib();
+}
+
 
-    glutSwapBuffers();  
+#ifdef SCENE_MODULE
+// Generada al cargar el modulo y vista como en inicio()
+SCENE_EXPORT void sceneInit() {
+    construirEscena();
+}
+
+SCENE_EXPORT const float sceneViewExtent = 5;
+#else
+void display(void) {
+    glClearColor(1, 1, 1, 1);  
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    drawShape();
+
+    presentFrame();  
 }
 
 
@@ -120,10 +141,16 @@ void inicio()
     glMatrixMode(GL_PROJECTION);
     gluOrtho2D(-a,a,-a,a);
     glClearColor(0,0,0,0);
+    construirEscena();
 }
 
 int main(int argc, char *argv[])
 {
+    HeadlessOptions headless;
+    if (parseHeadlessArgs(argc, argv, headless)) {
+        return runHeadless(headless, inicio, display, NULL);
+    }
+
     glutInit(&argc, argv); 
     glutInitWindowSize(800,800);
     glutInitWindowPosition(500,10);
@@ -136,4 +163,5 @@ int main(int argc, char *argv[])
     glutMainLoop();
 
     return EXIT_SUCCESS; 
-}
\ No newline at end of file
+}
+#endif // SCENE_MODULE
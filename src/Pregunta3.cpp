@@ -13,12 +13,26 @@
 #include <stdlib.h>
 #include <math.h>
 #include <cstdlib>
+
+#include "headless.cpp"
 #define PI 3.141592653589793f
 
+// Con -DSCENE_MODULE solo queda la escena, para ./build/gallery (scenemodule.cpp)
+#ifndef SCENE_MODULE
+// DEBUG
+#include "debug.cpp"
+#endif
+
+#include "disks.cpp"
+#include "scenemodule.h"
+
 
 float blanco[3]       = {1, 1, 1},
       negro[3]        = {0,0,0};
 
+// Todos los sectores de la escena, generados una vez en inicio()
+DiskBatch escena = {};
+
 void drawSector(
     float cx, float cy, 
     float radius,
@@ -26,49 +40,30 @@ void drawSector(
     float *RGB1, float *RGB2,
     float w = 1.0f,
     int segments=100) {
-  
-    glColor3fv(RGB1);   
 
-    glBegin(GL_TRIANGLE_FAN);
-    for (int i = 0; i < segments; i++) {
-        float theta = t1 + i * (t2 - t1) / segments;
-        float theta2 = t1 + (i + 1) * (t2 - t1) / segments;
-        float x1 = cx + radius * cosf(theta);
-        float y1 = cy + radius * sinf(theta);
-        float x2 = cx + radius * cosf(theta2);
-        float y2 = cy + radius * sinf(theta2);
-        glVertex2f(cx, cy);
-        glVertex2f(x1, y1);
-        glVertex2f(x2, y2);
+    if (t2 - t1 >= 2 * PI) {
+        addDisk(escena, cx, cy, radius, segments, RGB1, GL_TRIANGLE_FAN);
+        addDisk(escena, cx, cy, radius, segments, RGB2, GL_LINE_LOOP, w);
+        return;
     }
-    glEnd(); 
-
-    glColor3fv(RGB2);   
-    glLineWidth(w);
-
-    glBegin(GL_LINE_LOOP);
 
-    for (int i = 0; i < segments; i++) {
+    // Sector parcial: abanico desde el centro y arco como contorno
+    std::vector<float> arco;
+    for (int i = 0; i <= segments; i++) {
         float theta = t1 + i * (t2 - t1) / segments;
-        float theta2 = t1 + (i + 1) * (t2 - t1) / segments;
-        float x1 = cx + radius * cosf(theta);
-        float y1 = cy + radius * sinf(theta);
-        float x2 = cx + radius * cosf(theta2);
-        float y2 = cy + radius * sinf(theta2);
-        glVertex2f(x1, y1);
-        glVertex2f(x2, y2);
-    } 
-
-    glEnd(); 
+        arco.push_back(cx + radius * cosf(theta));
+        arco.push_back(cy + radius * sinf(theta));
+    }
+    std::vector<float> abanico = { cx, cy };
+    abanico.insert(abanico.end(), arco.begin(), arco.end());
+    addShape(escena, abanico, RGB1, GL_TRIANGLE_FAN);
+    addShape(escena, arco, RGB2, GL_LINE_LOOP, w);
 }
 
 
 
 
-void display(void) {
-    glClearColor(1, 1, 1, 1);  
-    glClear(GL_COLOR_BUFFER_BIT);
-
+void construirEscena() {
 
     for(int i =0; i<15;i++){
         float r = 4, theta = 2*PI/15;
@@ -112,9 +107,38 @@ void display(void) {
         float y = r*sinf(i*theta);
         drawSector(x,y,0.1,0,2*PI,blanco,negro);
     }
+}
+
+
+void drawShape() {
+    // Lineas sin suavizar, como las deja inicio(), tambien dentro de ./build/gallery
+    glPushAttrib(GL_ENABLE_BIT);
+    glDisable(GL_LINE_SMOOTH);
+    drawDiskBatch(escena);
+    glPopAttrib();
+}
+
+
+#ifdef SCENE_MODULE
+// Generada al cargar el modulo y vista como en inicio()
+SCENE_EXPORT void sceneInit() {
+    construirEscena();
+}
+
+SCENE_EXPORT const float sceneViewExtent = 5;
+#else
+void display(void) {
+    glClearColor(1, 1, 1, 1);  
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    // DEBUG
+    if (g_OverdrawMode) {
+        drawOverdraw(drawShape);
+    } else {
+        drawShape();
+    }
 
-    
-    glutSwapBuffers();  
+    presentFrame();  
 }
 
 
@@ -124,10 +148,16 @@ void inicio()
     glMatrixMode(GL_PROJECTION);
     gluOrtho2D(-a,a,-a,a);
     glClearColor(0,0,0,0);
+    construirEscena();
 }
 
 int main(int argc, char *argv[])
 {
+    HeadlessOptions headless;
+    if (parseHeadlessArgs(argc, argv, headless)) {
+        return runHeadless(headless, inicio, display, NULL);
+    }
+
     glutInit(&argc, argv); 
     glutInitWindowSize(800,800);
     glutInitWindowPosition(500,10);
@@ -137,7 +167,9 @@ int main(int argc, char *argv[])
     glutCreateWindow("Pregunta 3");
     inicio();
     glutDisplayFunc(display);
+    glutKeyboardFunc(keyboardCallback);
     glutMainLoop();
 
     return EXIT_SUCCESS; 
-}
\ No newline at end of file
+}
+#endif // SCENE_MODULE
@@ -13,8 +13,14 @@
 #include <stdlib.h>
 #include <math.h>
 #include <cstdlib>
+
+#include "headless.cpp"
 #define PI 3.141592653589793f
 
+#include "disks.cpp"
+// Con -DSCENE_MODULE solo queda la escena, para ./build/gallery (scenemodule.cpp)
+#include "scenemodule.h"
+
 
 
 
@@ -36,6 +42,9 @@ float amarillo[3]     = {1, 1, 0},
       negro[3]        = {0,0,0},
       celeste[3] = {0.5, 1, 1}; 
 
+// Todos los circulos y tangentes de la escena, generados una vez en inicio()
+DiskBatch escena = {};
+
 void drawTangentsToCircle(
         float cx, float cy,
         float radius,
@@ -64,21 +73,10 @@ void drawTangentsToCircle(
         float tx2 = cx + radius * cosf(theta2);
         float ty2 = cy + radius * sinf(theta2);
         
-        glColor3fv(RGB); // rojo
-        glBegin(GL_POLYGON);
-            glVertex2f(x2, y2);
-            glVertex2f(tx1, ty1);
-            glVertex2f(tx2, ty2);
-        glEnd();
-
-        // Dibuja las líneas tangentes
-        glColor3fv(RGB); 
-        glBegin(GL_LINE_LOOP);
-            glVertex2f(x2, y2);
-            glVertex2f(tx1, ty1);
-            glVertex2f(x2, y2);
-            glVertex2f(tx2, ty2);
-        glEnd();
+        addShape(escena, {x2, y2, tx1, ty1, tx2, ty2}, RGB, GL_TRIANGLE_FAN);
+
+        // Las líneas tangentes
+        addShape(escena, {x2, y2, tx1, ty1, x2, y2, tx2, ty2}, RGB, GL_LINE_LOOP);
     }
 
 void drawSector(
@@ -88,22 +86,18 @@ void drawSector(
         float t1, float t2,
         float *RGB, bool op) {
         
-        glColor3fv(RGB);
         int segments = 300;
-        
-        glBegin(GL_POLYGON);
-        //glVertex2f(cx, cy);
-        for (int i = 0; i < segments; ++i) {
-            float theta = t1 + i * (t2 - t1) / segments;
-            float theta2 = t1 + (i + 1) * (t2 - t1) / segments;
-            float x1 = cx + radius * cosf(theta);
-            float y1 = cy + radius * sinf(theta);
-            float x2 = cx + radius * cosf(theta2);
-            float y2 = cy + radius * sinf(theta2);
-            glVertex2f(x1, y1);
-            glVertex2f(x2, y2);
+        if (t2 - t1 >= 2 * PI) {
+            addDisk(escena, cx, cy, radius, segments, RGB, GL_TRIANGLE_FAN);
+        } else {
+            std::vector<float> arco;
+            for (int i = 0; i <= segments; ++i) {
+                float theta = t1 + i * (t2 - t1) / segments;
+                arco.push_back(cx + radius * cosf(theta));
+                arco.push_back(cy + radius * sinf(theta));
+            }
+            addShape(escena, arco, RGB, GL_TRIANGLE_FAN);
         }
-        glEnd();
         if (op)
         {
             drawTangentsToCircle(cx, cy, radius, tx, ty,RGB);
@@ -111,9 +105,7 @@ void drawSector(
     }
 
 
-void display(void) {
-    glClearColor(1, 1, 1, 1);  
-    glClear(GL_COLOR_BUFFER_BIT);
+void construirEscena() {
  drawSector(0, 0,0,0, 4.77,0, 2*PI,negro,false);
  drawSector(0, 0,0,0, 4.75,0, 2*PI,celeste,false);
 
@@ -202,9 +194,33 @@ drawSector(0, -1,0,0, 0.32,0, 2*PI,amarillo, true);
 drawSector(0, 0,0,0, 0.75,0, 2*PI,negro, false);
 drawSector(0, 0,0,0, 0.65,0, 2*PI,blanco, false);
 drawSector(0, 0,0,0, 0.55,0, 2*PI,rojo, false);
+}
 
 
-    glutSwapBuffers();  
+void drawShape() {
+    // Lineas sin suavizar, como las deja inicio(), tambien dentro de ./build/gallery
+    glPushAttrib(GL_ENABLE_BIT);
+    glDisable(GL_LINE_SMOOTH);
+    drawDiskBatch(escena);
+    glPopAttrib();
+}
+
+
+#ifdef SCENE_MODULE
+// Generada al cargar el modulo y vista como en inicio()
+SCENE_EXPORT void sceneInit() {
+    construirEscena();
+}
+
+SCENE_EXPORT const float sceneViewExtent = 5;
+#else
+void display(void) {
+    glClearColor(1, 1, 1, 1);  
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    drawShape();
+
+    presentFrame();  
 }
 
 
@@ -214,10 +230,16 @@ void inicio()
     glMatrixMode(GL_PROJECTION);
     gluOrtho2D(-a,a,-a,a);
     glClearColor(0,0,0,0);
+    construirEscena();
 }
 
 int main(int argc, char *argv[])
 {
+    HeadlessOptions headless;
+    if (parseHeadlessArgs(argc, argv, headless)) {
+        return runHeadless(headless, inicio, display, NULL);
+    }
+
     glutInit(&argc, argv); 
     glutInitWindowSize(800,800);
     glutInitWindowPosition(500,10);
@@ -230,4 +252,5 @@ int main(int argc, char *argv[])
     glutMainLoop();
 
     return EXIT_SUCCESS; 
-}
\ No newline at end of file
+}
+#endif // SCENE_MODULE
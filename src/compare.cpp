@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "headless.cpp"
+
+// IMAGE COMPARISON
+// ./build/compare <a.png> <b.png> [--threshold 0-255] [--tolerance PERCENT] [--diff FILE.png]
+// Counts the pixels where some RGB channel differs by more than threshold
+// and fails when they are more than tolerance percent of the image. Meant
+// for the software rasterizer against GL, run from a directory without the
+// scene's reference image:
+//     ./build/problema4 --headless 600x600 --frames 1 --out gl.png
+//     ./build/problema4 --headless 600x600 --frames 1 --soft --out soft.png
+//     ./build/compare gl.png soft.png
+// The defaults (128, 0.01%) let through the anti-aliased edges, which are at
+// most about 120 apart (llvmpipe's smoothed lines fall off a little
+// differently), and the odd pixel on a tiny circle's edge, but not a 1 px
+// gap between figures (problema4 900x900 with --fill nonzero: 0.027%) or
+// outlines blended twice at every joint (0.317%).
+// --diff writes the differing pixels in red over a faded copy of a.
+
+int main(int argc, char* argv[])
+{
+    const char* files[2] = { NULL, NULL };
+    int threshold = 128;
+    double tolerance = 0.01;
+    const char* diffOutput = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = std::min(std::max(atoi(argv[++i]), 0), 255);
+        } else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            tolerance = std::max(0.0, atof(argv[++i]));
+        } else if (strcmp(argv[i], "--diff") == 0 && i + 1 < argc) {
+            diffOutput = argv[++i];
+        } else if (!files[0]) {
+            files[0] = argv[i];
+        } else if (!files[1]) {
+            files[1] = argv[i];
+        }
+    }
+    if (!files[1]) {
+        std::cerr << "Usage: " << argv[0] << " <a.png> <b.png> [--threshold 0-255] [--tolerance PERCENT]"
+                  << " [--diff FILE.png]" << std::endl;
+        return 1;
+    }
+
+    int width[2], height[2], channels;
+    unsigned char* pixels[2];
+    for (int k = 0; k < 2; k++) {
+        pixels[k] = stbi_load(files[k], &width[k], &height[k], &channels, 4);
+        if (!pixels[k]) {
+            std::cerr << "ERROR: Could not load image '" << files[k] << "'" << std::endl;
+            std::cerr << "Reason: " << stbi_failure_reason() << std::endl;
+            return 1;
+        }
+    }
+    if (width[0] != width[1] || height[0] != height[1]) {
+        std::cerr << "ERROR: " << files[0] << " is " << width[0] << "x" << height[0] << ", "
+                  << files[1] << " is " << width[1] << "x" << height[1] << std::endl;
+        return 1;
+    }
+
+    int w = width[0], h = height[0];
+    size_t differing = 0;
+    int largest = 0;
+    std::vector<unsigned char> diff(diffOutput ? (size_t)w * h * 4 : 0);
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            const unsigned char* a = pixels[0] + ((size_t)y * w + x) * 4;
+            const unsigned char* b = pixels[1] + ((size_t)y * w + x) * 4;
+            int d = 0;
+            for (int c = 0; c < 3; c++) {
+                d = std::max(d, abs(a[c] - b[c]));
+            }
+            largest = std::max(largest, d);
+            bool differs = d > threshold;
+            differing += differs;
+            if (diffOutput) {
+                // writePNG takes the rows bottom-up
+                unsigned char* out = diff.data() + ((size_t)(h - 1 - y) * w + x) * 4;
+                for (int c = 0; c < 3; c++) {
+                    out[c] = differs ? (c == 0 ? 255 : 0) : (unsigned char)(192 + a[c] / 4);
+                }
+                out[3] = 255;
+            }
+        }
+    }
+    stbi_image_free(pixels[0]);
+    stbi_image_free(pixels[1]);
+
+    double percent = 100.0 * differing / ((double)w * h);
+    bool pass = percent <= tolerance;
+    printf("%zu of %d px differ by more than %d (%.3f%%, tolerance %.3f%%), largest difference %d: %s\n",
+        differing, w * h, threshold, percent, tolerance, largest, pass ? "ok" : "FAIL");
+    if (diffOutput && writePNG(diffOutput, w, h, diff.data())) {
+        std::cout << "Wrote " << diffOutput << std::endl;
+    }
+    return pass ? 0 : 1;
+}
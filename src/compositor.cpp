@@ -0,0 +1,161 @@
+#pragma once
+
+#include <GL/glut.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#include "glstate.cpp"
+#include "headless.cpp"
+#include "layered.cpp"
+
+// OVERLAY COMPOSITOR
+// 'k' with debug.cpp loaded
+// Debug programs split display() in two: a static layer (reference image,
+// scene, axes) and the overlay (coordinate text, Bezier editor). The static
+// layer is rendered once into an offscreen texture and only blitted to the
+// window afterwards, so a mouse move costs a copy plus the overlay. Anything
+// that changes the scene (keys, window size) invalidates it. Motion events are
+// coalesced into at most one pending redraw, and the time from the first of
+// them to the presented frame is reported with the frame stats ('f').
+bool g_CacheStatic = true;
+
+GLuint g_StaticFBO = 0;
+GLuint g_StaticTexture = 0;
+GLuint g_StaticDepth = 0; // Depth for layered mode, stencil for Loop-Blinn fills
+int g_StaticWidth = 0;
+int g_StaticHeight = 0;
+bool g_StaticValid = false;
+
+bool g_RedrawPending = false;
+std::chrono::steady_clock::time_point g_RedrawRequested;
+const int OVERLAY_REPORT_EVERY = 60; // Redraws per latency line
+int g_OverlayRedraws = 0;
+int g_OverlayEvents = 0;
+double g_OverlayLatencySum = 0.0;
+double g_OverlayLatencyMax = 0.0;
+
+void invalidateStaticLayer()
+{
+    g_StaticValid = false;
+}
+
+// (Re)allocate the cached layer to match the current viewport
+void resizeStaticTarget(int width, int height)
+{
+    if (width == g_StaticWidth && height == g_StaticHeight) {
+        return;
+    }
+    if (!g_StaticFBO) {
+        glGenFramebuffers(1, &g_StaticFBO);
+        glGenTextures(1, &g_StaticTexture);
+        glGenRenderbuffers(1, &g_StaticDepth);
+    }
+    g_StaticWidth = width;
+    g_StaticHeight = height;
+    g_StaticValid = false;
+
+    glBindTexture(GL_TEXTURE_2D, g_StaticTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    resetStateCache();
+
+    glBindRenderbuffer(GL_RENDERBUFFER, g_StaticDepth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    GLint previous = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previous);
+    glBindFramebuffer(GL_FRAMEBUFFER, g_StaticFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, g_StaticTexture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, g_StaticDepth);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "ERROR: Static layer framebuffer incomplete, caching disabled" << std::endl;
+        g_CacheStatic = false;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, previous);
+}
+
+// Draw the static layer, from the cache when it is still valid. Headless runs
+// always render it, so their frame times keep measuring the scene.
+void drawStaticLayer(void (*layer)())
+{
+    if (!g_CacheStatic || g_Headless) {
+        layer();
+        return;
+    }
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    resizeStaticTarget(viewport[2], viewport[3]);
+    if (!g_CacheStatic) {
+        layer();
+        return;
+    }
+
+    GLint previousFBO = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFBO);
+
+    if (!g_StaticValid) {
+        glPushAttrib(GL_VIEWPORT_BIT | GL_STENCIL_BUFFER_BIT);
+        glBindFramebuffer(GL_FRAMEBUFFER, g_StaticFBO);
+        glViewport(0, 0, viewport[2], viewport[3]);
+        glClearStencil(0);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+        glPopAttrib();
+        layer();
+        glBindFramebuffer(GL_FRAMEBUFFER, previousFBO);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        g_StaticValid = true;
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, g_StaticFBO);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, previousFBO);
+    glBlitFramebuffer(0, 0, viewport[2], viewport[3],
+        viewport[0], viewport[1], viewport[0] + viewport[2], viewport[1] + viewport[3],
+        GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFBO);
+}
+
+// Use instead of glutPostRedisplay() for events that only change the overlay
+void requestOverlayRedisplay()
+{
+    g_OverlayEvents++;
+    if (g_RedrawPending) {
+        return;
+    }
+    g_RedrawPending = true;
+    g_RedrawRequested = std::chrono::steady_clock::now();
+    glutPostRedisplay();
+}
+
+// Call after presentFrame(): closes the pending redraw and accounts its latency
+void endOverlayFrame()
+{
+    if (!g_RedrawPending) {
+        return;
+    }
+    g_RedrawPending = false;
+    if (!g_FrameStats) {
+        g_OverlayEvents = 0;
+        return;
+    }
+
+    glFinish();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - g_RedrawRequested).count();
+    g_OverlayRedraws++;
+    g_OverlayLatencySum += ms;
+    g_OverlayLatencyMax = std::max(g_OverlayLatencyMax, ms);
+    if (g_OverlayRedraws == OVERLAY_REPORT_EVERY) {
+        std::cout << "Overlay: events=" << g_OverlayEvents << " redraws=" << g_OverlayRedraws
+                  << " latency avg=" << g_OverlayLatencySum / g_OverlayRedraws << "ms"
+                  << " max=" << g_OverlayLatencyMax << "ms"
+                  << (g_CacheStatic ? " (static cached)" : " (static redrawn)") << std::endl;
+        g_OverlayRedraws = 0;
+        g_OverlayEvents = 0;
+        g_OverlayLatencySum = 0.0;
+        g_OverlayLatencyMax = 0.0;
+    }
+}
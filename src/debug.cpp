@@ -1,4 +1,6 @@
 #include <GL/glut.h>
+#include <chrono>
+#include <cstring>
 #include <iostream>
 #include <math.h>
 #include <stdlib.h>
@@ -7,12 +9,23 @@
 #include <windows.h>
 #endif
 
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
 #include <iomanip>
 #include <sstream>
 #include <string>
 
+#include "compositor.cpp"
+#include "editorpath.cpp"
+#include "glstate.cpp"
+#include "gpubezier.cpp"
+#include "loopblinn.cpp"
+#include "modern.cpp"
+#include "overdraw.cpp"
+#include "pathasset.cpp"
+#include "pointgrid.cpp"
+#include "refimage.cpp"
+#include "sdf.cpp"
+#include "text.cpp"
+
 typedef struct {
     float x;
     float y;
@@ -65,7 +78,7 @@ void drawQuadraticBezier(DebugPoint p0, DebugPoint p1, DebugPoint p2, int segmen
 // Helper to draw a small marker (e.g., a square or circle)
 void drawMarker(DebugPoint p, float r, float g, float b, float size = 0.015f)
 {
-    glColor3f(r, g, b);
+    stateColor3f(r, g, b);
     glPushMatrix();
     glTranslatef(p.x, p.y, 0.0f);
     glBegin(GL_QUADS);
@@ -77,70 +90,107 @@ void drawMarker(DebugPoint p, float r, float g, float b, float size = 0.015f)
     glPopMatrix();
 }
 
-bool loadTexture(const char* filename)
+const int REF_IMAGE_POLL_MS = 15;
+bool g_RefImagePolling = false;
+
+// Redraw the static layer while the reference image is decoded and its
+// levels are streamed in; drawImageReference() does the uploads
+void pollReferenceImage(int)
 {
-    int channels;
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char* data = stbi_load(filename, &imageWidth, &imageHeight, &channels, 0);
-
-    if (!data) {
-        std::cerr << "ERROR: Could not load texture file '" << filename << "'"
-                  << std::endl;
-        std::cerr << "Reason: " << stbi_failure_reason() << std::endl;
-        return false;
+    g_RefImagePolling = false;
+    if (!refImagePending() && !refImageStreaming()) {
+        return;
     }
+    g_RefImagePolling = true;
+    glutTimerFunc(REF_IMAGE_POLL_MS, pollReferenceImage, 0);
+    if (refImagePending() && !refImageReady()) {
+        return;
+    }
+    invalidateStaticLayer();
+    glutPostRedisplay();
+}
 
-    GLenum format;
-    if (channels == 1) {
-        format = GL_LUMINANCE;
-        std::cout << "Loaded texture: " << filename << " (" << imageWidth << "x"
-                  << imageHeight << "), Grayscale" << std::endl;
-    } else if (channels == 3) {
-        format = GL_RGB; // RGB
-        std::cout << "Loaded texture: " << filename << " (" << imageWidth << "x"
-                  << imageHeight << "), RGB" << std::endl;
-    } else if (channels == 4) {
-        format = GL_RGBA; // RGBA
-        std::cout << "Loaded texture: " << filename << " (" << imageWidth << "x"
-                  << imageHeight << "), RGBA" << std::endl;
-    } else {
-        // Should not happen with standard formats, but good to check
-        std::cerr << "ERROR: Unsupported number of channels (" << channels
-                  << ") in image '" << filename << "'" << std::endl;
-        stbi_image_free(data); // Free the allocated memory
+// Starts decoding in the background; drawImageReference() skips the image
+// until it is resident. Headless runs wait for it on their first frame.
+bool loadTexture(const char* filename)
+{
+    bool cached = g_RefImages.count(filename) > 0; // Loaded before: only made current
+    if (!startRefImageLoad(filename)) {
         return false;
     }
-
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-    glTexImage2D(GL_TEXTURE_2D, 0, format, imageWidth, imageHeight, 0, format,
-        GL_UNSIGNED_BYTE, data);
-    stbi_image_free(data);
-    glBindTexture(GL_TEXTURE_2D, 0);
-
+    imageWidth = g_RefImage->width;
+    imageHeight = g_RefImage->height;
+    if (!cached) {
+        g_ReportFirstFrame = true;
+    }
+    if (!g_Headless && !g_RefImagePolling) {
+        g_RefImagePolling = true;
+        glutTimerFunc(REF_IMAGE_POLL_MS, pollReferenceImage, 0);
+    }
     return true;
 }
 
-void drawCoordinatesText()
+// PATH ASSETS
+// In a window the scene's path file (pathasset.cpp) is polled for new
+// versions; one redraws the static layer, where pathFigure() generates again
+// the Figures of the paths that changed. The editor opens the path named
+// g_EditorPathName, from the file or as compiled in, and saves it back there.
+// The poll keeps running outside Bezier mode on purpose: the file is also
+// written by other processes (./build/trace --out, a second window), and a
+// GLUT loop only learns about that from a timer. A tick is one non-blocking
+// read() of the inotify descriptor, and nothing is redrawn unless the file
+// changed.
+const int PATH_ASSET_POLL_MS = 15;
+std::string g_EditorPathName = "segmentPoints"; // --edit-path NAME
+
+void pollPathAssetFile(int)
 {
-    if (!g_ShowMouseCoords) {
-        return;
+    glutTimerFunc(PATH_ASSET_POLL_MS, pollPathAssetFile, 0);
+    if (pollPathAssets()) {
+        std::cout << "Reloaded " << g_PathAssets.filename << std::endl;
+        invalidateStaticLayer();
+        glutPostRedisplay();
     }
+}
 
-    float radiusMouse = sqrtf(g_MouseWorldX * g_MouseWorldX + g_MouseWorldY * g_MouseWorldY);
-    float angleMouse = atan2f(g_MouseWorldY, g_MouseWorldX);
+// From init(), once main() has called openPathAssets(). Headless and --soft
+// runs read the file once and do not watch it.
+void watchPathAssets()
+{
+    if (g_Headless) {
+        return;
+    }
+    watchPathAssetFile();
+    if (g_PathAssets.inotify >= 0) {
+        glutTimerFunc(PATH_ASSET_POLL_MS, pollPathAssetFile, 0);
+    }
+}
 
-    std::stringstream ss;
-    ss << std::fixed << std::setprecision(3);
-    ss << "Clicked: X=" << g_MouseWorldX << ", Y=" << g_MouseWorldY
-       << ", r=" << radiusMouse << ", angle=" << angleMouse;
-    std::string coordString = ss.str();
+// The finalized path, written under g_EditorPathName; the scene is drawn
+// with it on the next frame. False when the scene has no path file.
+bool saveEditorPath()
+{
+    if (g_PathAssets.filename.empty() || g_FinalBezierPathPoints.size() < 3) {
+        return false;
+    }
+    auto start = std::chrono::steady_clock::now();
+    if (!savePathAsset(g_EditorPathName, &g_FinalBezierPathPoints[0].x, g_FinalBezierPathPoints.size())) {
+        return false;
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Saved path '" << g_EditorPathName << "' (" << g_FinalBezierPathPoints.size() << " points) to "
+              << g_PathAssets.filename << " in " << ms << " ms" << std::endl;
+    invalidateStaticLayer();
+    requestRedisplay();
+    return true;
+}
 
+// Black text with (x, y) in pixels from the bottom-left corner
+void drawHudText(float x, float y, const std::string& text)
+{
+    if (g_CoreProfile) {
+        return; // No matrix stack either
+    }
     glMatrixMode(GL_PROJECTION);
     glPushMatrix();
     glLoadIdentity();
@@ -151,27 +201,86 @@ void drawCoordinatesText()
     glMatrixMode(GL_MODELVIEW);
     glPushMatrix();
     glLoadIdentity();
-    glDisable(GL_TEXTURE_2D);
-    glColor3f(0.0f, 0.0f, 0.0f);
-    float xPos = 10.0f;
-    float yPos = 10.0f;
-    glRasterPos2f(xPos, yPos);
-    void* font = GLUT_BITMAP_HELVETICA_12;
-    for (char c : coordString) {
-        glutBitmapCharacter(font, c);
-    }
+    stateColor3f(0.0f, 0.0f, 0.0f);
+    drawAtlasText(TEXT_HELVETICA_12, x, y, text);
     glMatrixMode(GL_PROJECTION);
     glPopMatrix();
     glMatrixMode(GL_MODELVIEW);
     glPopMatrix();
 }
 
+void drawCoordinatesText()
+{
+    if (!g_ShowMouseCoords) {
+        return;
+    }
+
+    // Only reformatted when the point changes; the atlas caches the quads
+    static double lastX = NAN, lastY = NAN;
+    static std::string coordString;
+    if (g_MouseWorldX != lastX || g_MouseWorldY != lastY) {
+        lastX = g_MouseWorldX;
+        lastY = g_MouseWorldY;
+        float radiusMouse = sqrtf(g_MouseWorldX * g_MouseWorldX + g_MouseWorldY * g_MouseWorldY);
+        float angleMouse = atan2f(g_MouseWorldY, g_MouseWorldX);
+
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(3);
+        ss << "Clicked: X=" << g_MouseWorldX << ", Y=" << g_MouseWorldY
+           << ", r=" << radiusMouse << ", angle=" << angleMouse;
+        coordString = ss.str();
+    }
+
+    drawHudText(10.0f, 10.0f, coordString);
+}
+
+// GL calls issued/skipped by the state cache since the last HUD, shown with
+// the frame stats. Call last in display() so the whole frame is counted.
+void drawStateCounters()
+{
+    GLStateCounters counters = takeStateCounters();
+    if (!g_FrameStats) {
+        return;
+    }
+    std::stringstream ss;
+    ss << "GL state: issued=" << counters.issued << " skipped=" << counters.skipped
+       << (g_StateCache ? "" : " (cache off)");
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    drawHudText(10.0f, viewport[3] - 20.0f, ss.str());
+}
+
+// Fixed-function, like the rest of the debug overlay: nothing in --core runs
 void drawImageReference()
 {
-    glEnable(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    if (g_CoreProfile) {
+        return;
+    }
+
+    // On-screen size of the quad picks the mip level that has to be resident
+    GLdouble modelview[16], projection[16];
+    GLint viewport[4];
+    glGetDoublev(GL_MODELVIEW_MATRIX, modelview);
+    glGetDoublev(GL_PROJECTION_MATRIX, projection);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    GLdouble x0, y0, x1, y1, z;
+    gluProject(-1.0, -1.0, 0.0, modelview, projection, viewport, &x0, &y0, &z);
+    gluProject(1.0, 1.0, 0.0, modelview, projection, viewport, &x1, &y1, &z);
+    textureID = updateRefImage((int)ceil(fabs(x1 - x0)), (int)ceil(fabs(y1 - y0)), g_Headless);
+    if (refImageStreaming() && !g_Headless && !g_RefImagePolling) {
+        g_RefImagePolling = true; // Zoomed in: finer levels needed
+        glutTimerFunc(REF_IMAGE_POLL_MS, pollReferenceImage, 0);
+    }
+    if (!textureID) {
+        return;
+    }
 
-    glColor4f(1.0f, 1.0f, 1.0f, 0.3f);
+    // The texture stays bound; only texturing is switched off afterwards
+    stateTexture2D(true);
+    stateBindTexture(textureID);
+
+    stateColor4f(1.0f, 1.0f, 1.0f, 0.3f);
 
     glBegin(GL_QUADS);
     glTexCoord2f(1.0f, 1.0f);
@@ -184,24 +293,39 @@ void drawImageReference()
     glVertex2f(1.0f, -1.0f);
     glEnd();
 
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glDisable(GL_TEXTURE_2D);
+    stateTexture2D(false);
 }
 
 void drawAxes(float extent, float lineWidth)
 {
-    glLineWidth(lineWidth);
-    glColor4f(0, 0, 1, 0.3);
+    if (g_CoreProfile) {
+        return;
+    }
+    stateLineWidth(lineWidth);
+    stateColor4f(0, 0, 1, 0.3);
     glBegin(GL_LINES);
     glVertex2f(-extent, 0.0f);
     glVertex2f(extent, 0.0f);
     glVertex2f(0.0f, -extent);
     glVertex2f(0.0f, extent);
     glEnd();
-    glLineWidth(1.0f);
 }
 
-void mouseCallback(int button, int state, int x, int y)
+// EDITING EXISTING POINTS
+// Shift + left-drag grabs the finalized point nearest the cursor, anchor or
+// control, and moves it. g_EditorGrid indexes g_FinalBezierPathPoints for the
+// picks; new segments are appended to it and moves update it in place, so
+// neither hovering nor dragging scans the path. A dragged point snaps onto
+// another point within reach, or else to the grid when 'n' turns it on.
+const float EDITOR_GRID_CELL = 0.05f; // Also the snapping grid spacing
+const float EDITOR_PICK_PIXELS = 8.0f;
+PointGrid g_EditorGrid = { EDITOR_GRID_CELL, {}, 0 };
+int g_HoverPoint = -1; // Finalized point under the cursor, -1 if none
+int g_DragPoint = -1; // Finalized point being dragged, -1 if none
+bool g_SnapToGrid = false;
+
+// World point under the mouse at window (x, y)
+DebugPoint unprojectMouse(int x, int y)
 {
     GLdouble modelview[16];
     GLdouble projection[16];
@@ -216,14 +340,91 @@ void mouseCallback(int button, int state, int x, int y)
     GLdouble worldX, worldY, worldZ;
     gluUnProject(windowX, windowY, windowZ, modelview, projection, viewport,
         &worldX, &worldY, &worldZ);
+    return { (float)worldX, (float)worldY };
+}
 
-    g_MouseWorldX = worldX; // For general coordinate display
-    g_MouseWorldY = worldY;
-    g_ShowMouseCoords = true;
+// World distance spanned by EDITOR_PICK_PIXELS at window (x, y)
+float editorPickRadius(int x, int y)
+{
+    DebugPoint a = unprojectMouse(x, y);
+    DebugPoint b = unprojectMouse(x + (int)EDITOR_PICK_PIXELS, y);
+    return hypotf(b.x - a.x, b.y - a.y);
+}
+
+// Keeps the index in step with the path: appended points are added, a
+// shorter path is indexed again from scratch
+void syncEditorGrid()
+{
+    if (g_FinalBezierPathPoints.size() < g_EditorGrid.count) {
+        clearPointGrid(g_EditorGrid);
+    }
+    if (g_FinalBezierPathPoints.size() > g_EditorGrid.count) {
+        appendPointGrid(g_EditorGrid, &g_FinalBezierPathPoints[0].x, g_FinalBezierPathPoints.size());
+    }
+}
+
+// Finalized point nearest p within radius, other than exclude; -1 if none
+int pickEditorPoint(DebugPoint p, float radius, int exclude = -1)
+{
+    syncEditorGrid();
+    if (g_FinalBezierPathPoints.empty()) {
+        return -1;
+    }
+    return nearestPointGrid(g_EditorGrid, &g_FinalBezierPathPoints[0].x, p.x, p.y, radius, exclude);
+}
+
+// Where a dragged point lands: on another point within reach, else on the grid
+DebugPoint snapEditorPoint(int k, DebugPoint p, float radius)
+{
+    int target = pickEditorPoint(p, radius, k);
+    if (target >= 0) {
+        return g_FinalBezierPathPoints[target];
+    }
+    if (g_SnapToGrid) {
+        return { snapPointGrid(g_EditorGrid, p.x), snapPointGrid(g_EditorGrid, p.y) };
+    }
+    return p;
+}
 
-    DebugPoint currentPoint = { (float)worldX, (float)worldY };
+void moveEditorPoint(int k, DebugPoint p)
+{
+    syncEditorGrid();
+    DebugPoint& point = g_FinalBezierPathPoints[k];
+    movePointGrid(g_EditorGrid, k, point.x, point.y, p.x, p.y);
+    // The segment being defined starts at the last anchor
+    if ((size_t)k + 1 == g_FinalBezierPathPoints.size() && !g_CurrentBezierInteractivePoints.empty()
+        && g_CurrentBezierInteractivePoints[0].x == point.x && g_CurrentBezierInteractivePoints[0].y == point.y) {
+        g_CurrentBezierInteractivePoints[0] = p;
+    }
+    point = p;
+}
+
+void mouseCallback(int button, int state, int x, int y)
+{
+    DebugPoint currentPoint = unprojectMouse(x, y);
+    g_MouseWorldX = currentPoint.x; // For general coordinate display
+    g_MouseWorldY = currentPoint.y;
+    g_ShowMouseCoords = true;
 
     if (g_BezierMode) {
+        if (button == GLUT_LEFT_BUTTON && state == GLUT_DOWN && (glutGetModifiers() & GLUT_ACTIVE_SHIFT)) {
+            g_DragPoint = pickEditorPoint(currentPoint, editorPickRadius(x, y));
+            if (g_DragPoint >= 0) {
+                std::cout << "   Dragging " << (g_DragPoint % 2 ? "CONTROL" : "ANCHOR") << " point #" << g_DragPoint << std::endl;
+            } else {
+                std::cout << "   No finalized point under the cursor." << std::endl;
+            }
+            requestOverlayRedisplay();
+            return;
+        }
+        if (button == GLUT_LEFT_BUTTON && state == GLUT_UP && g_DragPoint >= 0) {
+            DebugPoint moved = g_FinalBezierPathPoints[g_DragPoint];
+            std::cout << "   Point #" << g_DragPoint << " moved to: (" << moved.x << ", " << moved.y << ")" << std::endl;
+            g_DragPoint = -1;
+            saveEditorPath();
+            requestOverlayRedisplay();
+            return;
+        }
         if (button == GLUT_LEFT_BUTTON && state == GLUT_DOWN) {
             g_PlacingControlPoint = false; // Stop placing control point if we were
 
@@ -284,50 +485,47 @@ void mouseCallback(int button, int state, int x, int y)
         }
     }
     // Non-Bezier mode clicks are handled by g_ShowMouseCoords update earlier
-    glutPostRedisplay();
+    requestOverlayRedisplay();
 }
 
 void mouseMotionCallback(int x, int y)
 {
     if (g_BezierMode) {
         // Convert screen coordinates to world coordinates
-        GLdouble modelview[16];
-        GLdouble projection[16];
-        GLint viewport[4];
-        glGetDoublev(GL_MODELVIEW_MATRIX, modelview);
-        glGetDoublev(GL_PROJECTION_MATRIX, projection);
-        glGetIntegerv(GL_VIEWPORT, viewport);
-        GLfloat windowY = (GLfloat)(viewport[3] - y);
-        GLfloat windowX = (GLfloat)x;
-        GLfloat windowZ = 0.0f;
-        GLdouble worldX_double, worldY_double, worldZ_double;
-        gluUnProject(windowX, windowY, windowZ, modelview, projection, viewport,
-            &worldX_double, &worldY_double, &worldZ_double);
-
-        DebugPoint motionPoint = { (float)worldX_double, (float)worldY_double };
+        DebugPoint motionPoint = unprojectMouse(x, y);
         g_TempMousePoint = motionPoint; // Store for potential drawing if needed
 
         // Update general mouse coordinate display
-        g_MouseWorldX = worldX_double;
-        g_MouseWorldY = worldY_double;
+        g_MouseWorldX = motionPoint.x;
+        g_MouseWorldY = motionPoint.y;
         // g_ShowMouseCoords = true; // (optional: show coords on motion too)
 
+        if (g_DragPoint >= 0) {
+            // Shift + left-drag of a finalized point
+            moveEditorPoint(g_DragPoint, snapEditorPoint(g_DragPoint, motionPoint, editorPickRadius(x, y)));
+            requestOverlayRedisplay();
+            return;
+        }
+        g_HoverPoint = g_PlacingControlPoint ? -1 : pickEditorPoint(motionPoint, editorPickRadius(x, y));
+
         if (g_BezierMode && g_PlacingControlPoint && g_CurrentBezierInteractivePoints.size() == 3) {
             // We are dragging the right mouse button to place/adjust P1 (control point)
             // P0 is at index 0, P1 (control) is at index 1, P2 is at index 2
             g_CurrentBezierInteractivePoints[1] = motionPoint;
-            glutPostRedisplay();
+            requestOverlayRedisplay();
         } else {
             // If just moving the mouse (no buttons pressed, or not in a relevant Bezier state)
             // and you want to see where a point *would* be placed.
             // This is good for passive feedback before a click.
-            glutPostRedisplay(); // Ensure coords text updates if shown
+            requestOverlayRedisplay(); // Ensure coords text updates if shown
         }
     }
 }
 
 void keyboardCallback(unsigned char key, int x, int y)
 {
+    invalidateStaticLayer(); // Most keys change what the scene looks like
+
     switch (key) {
     case ' ':
         debug = !debug;
@@ -339,15 +537,127 @@ void keyboardCallback(unsigned char key, int x, int y)
         glutPostRedisplay();
         break;
 
+    case 'o': // Toggle overdraw heatmap
+    case 'O':
+        g_OverdrawMode = !g_OverdrawMode;
+        if (g_OverdrawMode) {
+            std::cout << "Overdraw mode ON" << std::endl;
+        } else {
+            std::cout << "Overdraw mode OFF" << std::endl;
+        }
+        glutPostRedisplay();
+        break;
+
+    case 'l': // Toggle depth-layered rendering
+    case 'L':
+        g_LayeredMode = !g_LayeredMode;
+        if (g_LayeredMode) {
+            std::cout << "Layered mode ON" << std::endl;
+        } else {
+            std::cout << "Layered mode OFF" << std::endl;
+        }
+        glutPostRedisplay();
+        break;
+
+    case 'm': // Toggle shader/VAO draw path
+    case 'M':
+        g_ModernMode = !g_ModernMode;
+        if (g_ModernMode) {
+            std::cout << "Modern mode ON" << std::endl;
+        } else {
+            std::cout << "Modern mode OFF" << std::endl;
+        }
+        glutPostRedisplay();
+        break;
+
+    case 'e': // Toggle SDF circles/ellipses
+    case 'E':
+        g_SdfCircles = !g_SdfCircles;
+        if (g_SdfCircles) {
+            std::cout << "SDF circles ON" << std::endl;
+        } else {
+            std::cout << "SDF circles OFF" << std::endl;
+        }
+        glutPostRedisplay();
+        break;
+
+    case 'g': // Toggle GPU Bezier tessellation
+    case 'G':
+        g_GpuBezier = !g_GpuBezier;
+        if (g_GpuBezier) {
+            std::cout << "GPU Bezier ON" << std::endl;
+        } else {
+            std::cout << "GPU Bezier OFF" << std::endl;
+        }
+        glutPostRedisplay();
+        break;
+
+    case 'x': // Toggle exact (Loop-Blinn) Bezier fills
+    case 'X':
+        g_LoopBlinn = !g_LoopBlinn;
+        if (g_LoopBlinn) {
+            std::cout << "Loop-Blinn fills ON" << std::endl;
+        } else {
+            std::cout << "Loop-Blinn fills OFF" << std::endl;
+        }
+        glutPostRedisplay();
+        break;
+
+    case 'f': // Toggle per-frame fragment/time stats
+    case 'F':
+        g_FrameStats = !g_FrameStats;
+        if (g_FrameStats) {
+            std::cout << "Frame stats ON" << std::endl;
+        } else {
+            std::cout << "Frame stats OFF" << std::endl;
+        }
+        glutPostRedisplay();
+        break;
+
+    case 'k': // Toggle the cached static layer
+    case 'K':
+        g_CacheStatic = !g_CacheStatic;
+        if (g_CacheStatic) {
+            std::cout << "Static layer cache ON" << std::endl;
+        } else {
+            std::cout << "Static layer cache OFF" << std::endl;
+        }
+        glutPostRedisplay();
+        break;
+
+    case 's': // Toggle the GL state cache
+    case 'S':
+        g_StateCache = !g_StateCache;
+        resetStateCache();
+        if (g_StateCache) {
+            std::cout << "State cache ON" << std::endl;
+        } else {
+            std::cout << "State cache OFF" << std::endl;
+        }
+        glutPostRedisplay();
+        break;
+
     case 'b': // Toggle Bezier Mode
     case 'B':
         g_BezierMode = !g_BezierMode;
         g_CurrentBezierInteractivePoints.clear();
         g_PlacingControlPoint = false;
+        g_HoverPoint = -1;
+        g_DragPoint = -1;
         if (g_BezierMode) {
             std::cout << "-----------------------------------------------------" << std::endl;
             std::cout << "BEZIER MODE ACTIVATED" << std::endl;
             std::cout << "1. Left-click to set START point (P0)." << std::endl;
+            std::cout << "   Shift + left-drag moves a finalized point; 'n' toggles grid snapping." << std::endl;
+            if (g_FinalBezierPathPoints.empty()) {
+                std::vector<float> saved = pathAssetPoints(g_EditorPathName);
+                for (size_t i = 0; i + 1 < saved.size(); i += 2) {
+                    g_FinalBezierPathPoints.push_back({ saved[i], saved[i + 1] });
+                }
+                if (!saved.empty()) {
+                    std::cout << "   Editing path '" << g_EditorPathName << "' (" << saved.size() / 2 << " points)" << std::endl;
+                }
+            }
             if (!g_FinalBezierPathPoints.empty()) {
                 // Automatically use the last point of the previous segment as the new P0
                 DebugPoint lastPoint = g_FinalBezierPathPoints.back();
@@ -360,16 +670,16 @@ void keyboardCallback(unsigned char key, int x, int y)
         } else {
             std::cout << "BEZIER MODE DEACTIVATED" << std::endl;
             std::cout << "-----------------------------------------------------" << std::endl;
-            // Output the collected points when exiting Bezier Mode
-            if (!g_FinalBezierPathPoints.empty()) {
-                std::cout << "Collected Bezier Path Points (copy this into your vector):" << std::endl;
-                std::cout << "std::vector<Point> segmentPoints = {" << std::endl;
+            // Save the path, or print it when the scene has no path file
+            if (!g_FinalBezierPathPoints.empty() && !saveEditorPath()) {
+                std::cout << "Collected Bezier Path Points (copy this into your vector):\n";
+                std::cout << "std::vector<Point> " << g_EditorPathName << " = {\n";
                 for (size_t i = 0; i < g_FinalBezierPathPoints.size(); ++i) {
                     std::cout << "    { " << g_FinalBezierPathPoints[i].x << "f, " << g_FinalBezierPathPoints[i].y << "f }";
                     if (i < g_FinalBezierPathPoints.size() - 1) {
                         std::cout << ",";
                     }
-                    std::cout << std::endl;
+                    std::cout << "\n";
                 }
                 std::cout << "};" << std::endl;
             }
@@ -392,6 +702,7 @@ void keyboardCallback(unsigned char key, int x, int y)
             g_FinalBezierPathPoints.push_back(p2);
 
             std::cout << "Segment Added: P0(" << p0.x << "," << p0.y << ") - P1_ctrl(" << p1.x << "," << p1.y << ") - P2(" << p2.x << "," << p2.y << ")" << std::endl;
+            saveEditorPath();
 
             // Prepare for the next segment: P2 becomes the new P0
             g_CurrentBezierInteractivePoints.clear();
@@ -409,6 +720,13 @@ void keyboardCallback(unsigned char key, int x, int y)
         glutPostRedisplay();
         break;
 
+    case 'n': // Toggle snapping dragged points to the grid
+    case 'N':
+        g_SnapToGrid = !g_SnapToGrid;
+        std::cout << "Grid snapping " << (g_SnapToGrid ? "ON" : "OFF") << " (" << EDITOR_GRID_CELL << " units)" << std::endl;
+        glutPostRedisplay();
+        break;
+
     case 'c': // Clear current Bezier segment and optionally all points
     case 'C':
         if (g_BezierMode) {
@@ -435,32 +753,71 @@ void keyboardCallback(unsigned char key, int x, int y)
     }
 }
 
+// --editor-stress N: an N-segment spiral in the editor, one control point
+// moved and picked per frame as if it were being dragged. With the frame stats ('f'),
+// how many segments had to be tessellated again is printed every 60 frames.
+int g_EditorStress = 0;
+int g_EditorStressFrame = 0;
+
+// --editor-stress N, and --edit-path NAME for g_EditorPathName
+void parseEditorArgs(int argc, char* argv[])
+{
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--editor-stress") == 0) {
+            g_EditorStress = std::max(0, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--edit-path") == 0) {
+            g_EditorPathName = argv[++i];
+        }
+    }
+}
+
+void stepEditorStress()
+{
+    if (!g_EditorStress) {
+        return;
+    }
+    std::vector<DebugPoint>& path = g_FinalBezierPathPoints;
+    if (path.empty()) {
+        g_BezierMode = true;
+        for (int k = 0; k <= 2 * g_EditorStress; k++) {
+            float t = (float)k / (2 * g_EditorStress);
+            float angle = t * 40.0f * (float)M_PI;
+            float radius = 0.05f + 0.9f * t;
+            path.push_back({ radius * cosf(angle), radius * sinf(angle) });
+        }
+    }
+    // Dragged through the index as a mouse would, hovering where it lands
+    int segment = g_EditorStressFrame % g_EditorStress;
+    DebugPoint control = path[1 + 2 * segment];
+    control.y += (g_EditorStressFrame / g_EditorStress) % 2 ? -0.01f : 0.01f;
+    moveEditorPoint(1 + 2 * segment, control);
+    g_HoverPoint = pickEditorPoint(control, 0.02f);
+    g_EditorStressFrame++;
+
+    if (g_FrameStats && g_EditorStressFrame % 60 == 0) {
+        std::cout << "Editor path: " << g_EditorStress << " segments, " << takeEditorPathCount()
+                  << " tessellated in the last 60 frames" << std::endl;
+    }
+    if (!g_Headless) {
+        requestOverlayRedisplay();
+    }
+}
+
 void drawBezierDebug()
 {
+    stepEditorStress();
+
     // --- BEZIER MODE DRAWING LOGIC ---
-    if (g_BezierMode) {
-        // Draw finalized path segments
+    if (g_BezierMode && !g_CoreProfile) {
+        stateLineWidth(1.0f);
+        // Finalized path: cached tessellation, only moved segments redone
+        static_assert(sizeof(DebugPoint) == 2 * sizeof(float), "DebugPoint must be an x, y pair");
         if (g_FinalBezierPathPoints.size() >= 3) {
-            glColor3f(0.4f, 0.4f, 1.0f); // Color for finalized path
-            glLineWidth(1.5f);
-            for (size_t i = 0; (i + 2) < g_FinalBezierPathPoints.size(); i += 2) {
-                // Path is P0, C1, P1, C2, P2 ...
-                // A segment is P_i, C_i+1, P_i+1 if P_i is an anchor.
-                // More directly: P0, P1_ctrl, P2. So every 3 points in g_FinalBezierPathPoints.
-                // However, the structure is (coord, control, coord, control, coord...)
-                // So g_FinalBezierPathPoints[i] is P_start, g_FinalBezierPathPoints[i+1] is P_control, g_FinalBezierPathPoints[i+2] is P_end
-                if ((i % 2 == 0) && (i + 2 < g_FinalBezierPathPoints.size())) { // Ensure we have a full P0, C, P2 triplet
-                    DebugPoint segP0 = g_FinalBezierPathPoints[i];
-                    DebugPoint segP1_ctrl = g_FinalBezierPathPoints[i + 1];
-                    DebugPoint segP2 = g_FinalBezierPathPoints[i + 2];
-                    drawQuadraticBezier(segP0, segP1_ctrl, segP2);
-                    // Draw markers for finalized segment points
-                    drawMarker(segP0, 0.3f, 0.3f, 0.8f, 0.01f); // Start
-                    drawMarker(segP1_ctrl, 0.3f, 0.8f, 0.3f, 0.01f); // Control
-                    drawMarker(segP2, 0.3f, 0.3f, 0.8f, 0.01f); // End
-                }
-            }
-            glLineWidth(1.0f);
+            drawEditorPath(&g_FinalBezierPathPoints[0].x, g_FinalBezierPathPoints.size());
+        }
+        int picked = g_DragPoint >= 0 ? g_DragPoint : g_HoverPoint;
+        if (picked >= 0 && (size_t)picked < g_FinalBezierPathPoints.size()) {
+            drawMarker(g_FinalBezierPathPoints[picked], 1.0f, 0.5f, 0.0f, 0.02f); // Orange: grabbable
         }
 
         // Draw current interactive points and curve
@@ -474,7 +831,7 @@ void drawBezierDebug()
                     p_potential_p2_or_p1 = g_CurrentBezierInteractivePoints[1];
                     drawMarker(p_potential_p2_or_p1, 0.0f, 0.0f, 1.0f); // P2 in Blue
                                                                         // Draw a line from P0 to P2 if only these two are set
-                    glColor3f(0.7f, 0.7f, 0.7f); // Light grey line
+                    stateColor3f(0.7f, 0.7f, 0.7f); // Light grey line
                     glBegin(GL_LINES);
                     glVertex2f(p0.x, p0.y);
                     glVertex2f(p_potential_p2_or_p1.x, p_potential_p2_or_p1.y);
@@ -484,7 +841,7 @@ void drawBezierDebug()
                     // This needs g_TempMousePoint to be updated by passive motion
                     if (!g_PlacingControlPoint) { // Only if not actively dragging
                         drawMarker(g_TempMousePoint, 0.0f, 0.8f, 0.0f, 0.01f); // Temporary Control Point in light green
-                        glColor3f(0.0f, 0.8f, 0.0f); // Preview curve color (e.g., light green)
+                        stateColor3f(0.0f, 0.8f, 0.0f); // Preview curve color (e.g., light green)
                         glEnable(GL_LINE_STIPPLE);
                         glLineStipple(1, 0xAAAA); // Dashed line
                         drawQuadraticBezier(p0, g_TempMousePoint, p_potential_p2_or_p1);
@@ -499,13 +856,13 @@ void drawBezierDebug()
                     drawMarker(p2_end, 0.0f, 0.0f, 1.0f); // P2 (End) in Blue
 
                     // Draw the interactive Bezier curve
-                    glColor3f(0.0f, 0.6f, 0.0f); // Active Bezier curve color (e.g., darker green)
-                    glLineWidth(2.0f);
+                    stateColor3f(0.0f, 0.6f, 0.0f); // Active Bezier curve color (e.g., darker green)
+                    stateLineWidth(2.0f);
                     drawQuadraticBezier(p0, p1_control, p2_end);
-                    glLineWidth(1.0f);
+                    stateLineWidth(1.0f);
 
                     // Draw lines from P0-P1 and P1-P2 (control polygon)
-                    glColor3f(0.5f, 0.5f, 0.5f); // Grey for control lines
+                    stateColor3f(0.5f, 0.5f, 0.5f); // Grey for control lines
                     glBegin(GL_LINE_STRIP);
                     glVertex2f(p0.x, p0.y);
                     glVertex2f(p1_control.x, p1_control.y);
@@ -514,7 +871,7 @@ void drawBezierDebug()
                 }
             } else { // Only P0 is set, show temp mouse point for P2
                 drawMarker(g_TempMousePoint, 0.0f, 0.0f, 0.8f, 0.01f); // Light blue for potential P2
-                glColor3f(0.7f, 0.7f, 0.7f);
+                stateColor3f(0.7f, 0.7f, 0.7f);
                 glBegin(GL_LINES);
                 glVertex2f(p0.x, p0.y);
                 glVertex2f(g_TempMousePoint.x, g_TempMousePoint.y);
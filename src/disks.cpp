@@ -0,0 +1,176 @@
+#pragma once
+
+#include "disks.h"
+
+// A scene module (scenemodule.cpp) uses the host's
+#ifndef SCENE_MODULE
+
+#include <GL/glut.h>
+#include <map>
+#include <math.h>
+#include <vector>
+
+#include "glstate.cpp"
+#include "sdf.cpp"
+
+// DISK BATCH
+// Scenes made of many circles (the Pregunta rings) describe each circle once
+// as an instance (center, radius, color, fill/outline). At startup every
+// instance is expanded from a shared, precomputed unit circle into a single
+// vertex buffer, and a frame is drawn with one glMultiDrawArrays per run of
+// instances that share primitive and line width. When SDF circles are
+// available, fills and outlines of round disks become one quad each instead,
+// and consecutive ones are drawn together with a single call.
+
+// cos/sin of i * 2pi / segments, shared by every instance with that segment count
+const std::vector<float>& unitCircle(int segments)
+{
+    static std::map<int, std::vector<float>> cache;
+    std::vector<float>& circle = cache[segments];
+    if (circle.empty()) {
+        circle.resize(2 * segments);
+        for (int i = 0; i < segments; i++) {
+            float theta = i * (2.0f * (float)M_PI) / segments;
+            circle[2 * i] = cosf(theta);
+            circle[2 * i + 1] = sinf(theta);
+        }
+    }
+    return circle;
+}
+
+void addDisk(DiskBatch& batch, float cx, float cy, float radius, int segments,
+    const float* RGB, GLenum mode, float width)
+{
+    DiskInstance d;
+    d.mode = mode;
+    d.width = width;
+    d.r = RGB[0];
+    d.g = RGB[1];
+    d.b = RGB[2];
+    d.cx = cx;
+    d.cy = cy;
+    d.radius = radius;
+    d.segments = segments;
+    batch.instances.push_back(d);
+    batch.built = false;
+}
+
+// Arbitrary shape (x, y pairs) kept in order with the disks around it
+void addShape(DiskBatch& batch, const std::vector<float>& points, const float* RGB,
+    GLenum mode, float width)
+{
+    DiskInstance d;
+    d.mode = mode;
+    d.width = width;
+    d.r = RGB[0];
+    d.g = RGB[1];
+    d.b = RGB[2];
+    d.cx = d.cy = d.radius = 0;
+    d.segments = 0;
+    d.points = points;
+    batch.instances.push_back(d);
+    batch.built = false;
+}
+
+bool isSdfDisk(const DiskInstance& d)
+{
+    return d.segments >= SDF_MIN_SEGMENTS && (d.mode == GL_TRIANGLE_FAN || d.mode == GL_LINE_LOOP);
+}
+
+// Expand all instances into one interleaved x, y, r, g, b buffer (plus the
+// SDF quads when batch.sdf is set)
+void buildDiskBatch(DiskBatch& batch)
+{
+    std::vector<float> vertices;
+    std::vector<float> quads;
+    batch.runs.clear();
+
+    for (const DiskInstance& d : batch.instances) {
+        if (batch.sdf && isSdfDisk(d)) {
+            SdfShape shape = { d.cx, d.cy, d.radius, d.radius, 0.0f,
+                d.mode == GL_LINE_LOOP ? d.width : 0.0f, 0.0f, 2.0f * (float)M_PI, d.r, d.g, d.b };
+            GLint first = (GLint)(quads.size() / SDF_FLOATS_PER_VERTEX);
+            appendSdfQuad(quads, shape);
+            if (batch.runs.empty() || !batch.runs.back().sdf) {
+                DiskRun run;
+                run.mode = GL_QUADS;
+                run.width = 1.0f;
+                run.sdf = true;
+                run.first.push_back(first);
+                run.count.push_back(0);
+                batch.runs.push_back(run);
+            }
+            batch.runs.back().count[0] += 4;
+            continue;
+        }
+
+        GLint first = (GLint)(vertices.size() / 5);
+        if (d.segments > 0) {
+            const std::vector<float>& unit = unitCircle(d.segments);
+            for (int i = 0; i < d.segments; i++) {
+                float v[5] = { d.cx + d.radius * unit[2 * i], d.cy + d.radius * unit[2 * i + 1], d.r, d.g, d.b };
+                vertices.insert(vertices.end(), v, v + 5);
+            }
+        } else {
+            for (size_t i = 0; i + 1 < d.points.size(); i += 2) {
+                float v[5] = { d.points[i], d.points[i + 1], d.r, d.g, d.b };
+                vertices.insert(vertices.end(), v, v + 5);
+            }
+        }
+        GLsizei count = (GLsizei)(vertices.size() / 5) - first;
+
+        if (batch.runs.empty() || batch.runs.back().sdf || batch.runs.back().mode != d.mode || batch.runs.back().width != d.width) {
+            DiskRun run;
+            run.mode = d.mode;
+            run.width = d.width;
+            run.sdf = false;
+            batch.runs.push_back(run);
+        }
+        batch.runs.back().first.push_back(first);
+        batch.runs.back().count.push_back(count);
+    }
+
+    if (!batch.vbo) {
+        glGenBuffers(1, &batch.vbo);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, batch.vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    if (!quads.empty()) {
+        if (!batch.sdfVbo) {
+            glGenBuffers(1, &batch.sdfVbo);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, batch.sdfVbo);
+        glBufferData(GL_ARRAY_BUFFER, quads.size() * sizeof(float), quads.data(), GL_STATIC_DRAW);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    batch.built = true;
+}
+
+void drawDiskBatch(DiskBatch& batch)
+{
+    bool sdf = sdfAvailable();
+    if (!batch.built || batch.sdf != sdf) {
+        batch.sdf = sdf;
+        buildDiskBatch(batch);
+    }
+
+    for (const DiskRun& run : batch.runs) {
+        if (run.sdf) {
+            glBindBuffer(GL_ARRAY_BUFFER, batch.sdfVbo);
+            drawSdfArrays(NULL, run.first[0], run.count[0]);
+            continue;
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, batch.vbo);
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_COLOR_ARRAY);
+        glVertexPointer(2, GL_FLOAT, 5 * sizeof(float), (void*)0);
+        glColorPointer(3, GL_FLOAT, 5 * sizeof(float), (void*)(2 * sizeof(float)));
+        stateLineWidth(run.width);
+        glMultiDrawArrays(run.mode, run.first.data(), run.count.data(), (GLsizei)run.first.size());
+        resetStateColor();
+        glDisableClientState(GL_COLOR_ARRAY);
+        glDisableClientState(GL_VERTEX_ARRAY);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+#endif // SCENE_MODULE
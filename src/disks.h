@@ -0,0 +1,40 @@
+#pragma once
+
+#include <GL/glut.h>
+#include <vector>
+
+// What the scenes use of disks.cpp. A scene module (scenemodule.cpp) only
+// includes this: the batches are the scene's, the code drawing them and the
+// state behind it (glstate.cpp, sdf.cpp) the host's.
+
+typedef struct {
+    GLenum mode; // GL_TRIANGLE_FAN (fill), GL_LINE_LOOP (outline), ...
+    float width;
+    float r, g, b;
+    float cx, cy, radius;
+    int segments;
+    std::vector<float> points; // Custom shape when segments == 0
+} DiskInstance;
+
+typedef struct {
+    GLenum mode;
+    float width;
+    bool sdf; // Quads in sdfVbo: first[0], count[0]
+    std::vector<GLint> first;
+    std::vector<GLsizei> count;
+} DiskRun;
+
+typedef struct {
+    std::vector<DiskInstance> instances;
+    std::vector<DiskRun> runs;
+    GLuint vbo;
+    GLuint sdfVbo;
+    bool built;
+    bool sdf; // Built with SDF quads for round disks
+} DiskBatch;
+
+void addDisk(DiskBatch& batch, float cx, float cy, float radius, int segments,
+    const float* RGB, GLenum mode, float width = 1.0f);
+void addShape(DiskBatch& batch, const std::vector<float>& points, const float* RGB,
+    GLenum mode, float width = 1.0f);
+void drawDiskBatch(DiskBatch& batch);
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <GL/glut.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "glstate.cpp"
+#include "headless.cpp"
+
+// EDITOR PATH CACHE
+// ./build/<scene> --editor-stress N with debug.cpp loaded
+// The finalized path of the Bezier editor stays tessellated in two VBOs: the
+// curves, one fixed slot of EDITOR_PATH_STEPS + 1 vertices per segment, and
+// the marker quads, anchors in blue and controls in green. Each frame the
+// path is compared with the copy last tessellated; only the segments with a
+// moved point are evaluated again, and each run of them is one
+// glBufferSubData. A segment uses as many steps of its slot as its curvature
+// needs (EDITOR_PATH_FLATNESS), so long paths of short segments do not cost
+// thousands of needless lines. Drawing is two calls however long the path is:
+// one glMultiDrawArrays over the slots and one for the markers.
+const int EDITOR_PATH_STEPS = 30; // Most steps per segment
+const float EDITOR_PATH_FLATNESS = 0.001f; // Max chord error, world units
+const float EDITOR_MARKER_SIZE = 0.01f;
+
+typedef struct {
+    GLuint curveVBO, markerVBO;
+    size_t capacity; // Points the buffers have room for
+    std::vector<float> points; // x, y pairs as tessellated
+    std::vector<GLint> firsts; // Slot start per segment
+    std::vector<GLsizei> counts; // Vertices used per slot
+    unsigned retessellated; // Segments evaluated since takeEditorPathCount()
+} EditorPathCache;
+
+EditorPathCache g_EditorPath = { 0, 0, 0, {}, {}, {}, 0 };
+
+size_t editorPathSegments(size_t count)
+{
+    return count >= 3 ? (count - 1) / 2 : 0;
+}
+
+// Vertices of segment s into its slot (P0, then t = 1/n .. 1), x, y pairs.
+// Returns how many were written.
+int tessellateEditorSegment(const float* xy, size_t s, float* out)
+{
+    const float* p = xy + 4 * s; // P0, C, P1
+    // Chord error with n steps is |P0 - 2C + P1| / (4 n^2)
+    float dx = p[0] - 2 * p[2] + p[4], dy = p[1] - 2 * p[3] + p[5];
+    int steps = (int)ceilf(sqrtf(sqrtf(dx * dx + dy * dy) / (4 * EDITOR_PATH_FLATNESS)));
+    steps = std::min(std::max(steps, 1), EDITOR_PATH_STEPS);
+    for (int i = 0; i <= steps; i++) {
+        float t = (float)i / steps;
+        float u = 1.0f - t;
+        *out++ = u * u * p[0] + 2 * u * t * p[2] + t * t * p[4];
+        *out++ = u * u * p[1] + 2 * u * t * p[3] + t * t * p[5];
+    }
+    return steps + 1;
+}
+
+// Marker quad of point k: x, y, r, g, b per corner
+void editorMarker(const float* xy, size_t k, float* out)
+{
+    const float h = EDITOR_MARKER_SIZE / 2;
+    const float corners[8] = { -h, -h, h, -h, h, h, -h, h };
+    bool control = k % 2 == 1;
+    for (int c = 0; c < 4; c++) {
+        *out++ = xy[2 * k] + corners[2 * c];
+        *out++ = xy[2 * k + 1] + corners[2 * c + 1];
+        *out++ = 0.3f;
+        *out++ = control ? 0.8f : 0.3f;
+        *out++ = control ? 0.3f : 0.8f;
+    }
+}
+
+// Bring both buffers up to date with count points (x, y pairs)
+void updateEditorPath(const float* xy, size_t count)
+{
+    EditorPathCache& cache = g_EditorPath;
+    if (count > cache.capacity) {
+        if (!cache.curveVBO) {
+            glGenBuffers(1, &cache.curveVBO);
+            glGenBuffers(1, &cache.markerVBO);
+        }
+        cache.capacity = std::max(count * 2, (size_t)64);
+        glBindBuffer(GL_ARRAY_BUFFER, cache.curveVBO);
+        glBufferData(GL_ARRAY_BUFFER, cache.capacity / 2 * (EDITOR_PATH_STEPS + 1) * 2 * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, cache.markerVBO);
+        glBufferData(GL_ARRAY_BUFFER, cache.capacity * 20 * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+        cache.points.clear(); // New storage: everything is stale
+    }
+
+    size_t known = std::min(cache.points.size() / 2, count);
+    auto moved = [&](size_t k) {
+        return k >= known || cache.points[2 * k] != xy[2 * k] || cache.points[2 * k + 1] != xy[2 * k + 1];
+    };
+
+    // Runs of moved points -> marker uploads
+    thread_local std::vector<float> staging;
+    glBindBuffer(GL_ARRAY_BUFFER, cache.markerVBO);
+    for (size_t k = 0; k < count;) {
+        if (!moved(k)) {
+            k++;
+            continue;
+        }
+        size_t end = k;
+        while (end < count && moved(end)) {
+            end++;
+        }
+        staging.resize((end - k) * 20);
+        for (size_t j = k; j < end; j++) {
+            editorMarker(xy, j, &staging[(j - k) * 20]);
+        }
+        glBufferSubData(GL_ARRAY_BUFFER, k * 20 * sizeof(float), staging.size() * sizeof(float), staging.data());
+        k = end;
+    }
+
+    // Runs of segments with a moved point -> curve uploads
+    const size_t slot = EDITOR_PATH_STEPS + 1;
+    glBindBuffer(GL_ARRAY_BUFFER, cache.curveVBO);
+    size_t segments = editorPathSegments(count);
+    cache.firsts.resize(segments);
+    cache.counts.resize(segments);
+    auto dirty = [&](size_t s) { return moved(2 * s) || moved(2 * s + 1) || moved(2 * s + 2); };
+    for (size_t s = 0; s < segments;) {
+        if (!dirty(s)) {
+            s++;
+            continue;
+        }
+        size_t end = s;
+        while (end < segments && dirty(end)) {
+            end++;
+        }
+        staging.resize((end - s) * slot * 2);
+        for (size_t j = s; j < end; j++) {
+            cache.firsts[j] = (GLint)(j * slot);
+            cache.counts[j] = tessellateEditorSegment(xy, j, &staging[(j - s) * slot * 2]);
+        }
+        size_t used = (end - s - 1) * slot + cache.counts[end - 1]; // Last slot's tail is unused
+        glBufferSubData(GL_ARRAY_BUFFER, s * slot * 2 * sizeof(float), used * 2 * sizeof(float), staging.data());
+        cache.retessellated += end - s;
+        s = end;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    cache.points.assign(xy, xy + 2 * count);
+}
+
+// Draw the finalized path, count points P0, C, P1, C, P2, ... as x, y pairs
+void drawEditorPath(const float* xy, size_t count)
+{
+    if (g_CoreProfile || count < 3) {
+        return;
+    }
+    updateEditorPath(xy, count);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, g_EditorPath.curveVBO);
+    glVertexPointer(2, GL_FLOAT, 0, (void*)0);
+    stateColor3f(0.4f, 0.4f, 1.0f);
+    stateLineWidth(1.5f);
+    glMultiDrawArrays(GL_LINE_STRIP, g_EditorPath.firsts.data(), g_EditorPath.counts.data(), (GLsizei)editorPathSegments(count));
+    stateLineWidth(1.0f);
+
+    glEnableClientState(GL_COLOR_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, g_EditorPath.markerVBO);
+    glVertexPointer(2, GL_FLOAT, 5 * sizeof(float), (void*)0);
+    glColorPointer(3, GL_FLOAT, 5 * sizeof(float), (void*)(2 * sizeof(float)));
+    glDrawArrays(GL_QUADS, 0, (GLsizei)(4 * count));
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    resetStateColor();
+}
+
+// Segments re-tessellated since the last call, then start over
+unsigned takeEditorPathCount()
+{
+    unsigned count = g_EditorPath.retessellated;
+    g_EditorPath.retessellated = 0;
+    return count;
+}
@@ -9,8 +9,10 @@
 #include <windows.h>
 #endif
 
+#include "../headless.cpp"
+
 // DEBUG
-#include "debug.cpp"
+#include "../debug.cpp"
 
 // --- Estructuras ---
 
@@ -291,8 +293,8 @@ void display(void)
 
     // DEBUG
     if (debug) {
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        stateBlend(true);
+        stateBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
         drawImageReference();
     }
 
@@ -303,10 +305,10 @@ void display(void)
     if (debug) {
         drawAxes(1.1f, 1.5f);
         drawCoordinatesText();
-        glDisable(GL_BLEND);
+        stateBlend(false);
     }
 
-    glutSwapBuffers();
+    presentFrame();
 }
 
 void reshape(int w, int h)
@@ -330,15 +332,8 @@ void reshape(int w, int h)
     glLoadIdentity();
 }
 
-int main(int argc, char* argv[])
+void init()
 {
-    glutInit(&argc, argv);
-    glutInitDisplayMode(GLUT_RGBA | GLUT_DOUBLE | GLUT_DEPTH);
-    glutInitWindowSize(600, 600);
-    glutInitWindowPosition(100, 100);
-    glutCreateWindow("Main");
-
-    // Init
     // DEBUG
     if (!loadTexture("main.png")) {
         std::cerr << "Failed to load texture. Exiting." << std::endl;
@@ -350,6 +345,22 @@ int main(int argc, char* argv[])
     glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
     glEnable(GL_LINE_SMOOTH);
     glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
+}
+
+int main(int argc, char* argv[])
+{
+    HeadlessOptions headless;
+    if (parseHeadlessArgs(argc, argv, headless)) {
+        return runHeadless(headless, init, display, reshape);
+    }
+
+    glutInit(&argc, argv);
+    glutInitDisplayMode(GLUT_RGBA | GLUT_DOUBLE | GLUT_DEPTH);
+    glutInitWindowSize(600, 600);
+    glutInitWindowPosition(100, 100);
+    glutCreateWindow("Main");
+
+    init();
 
     // Register GLUT callbacks
     glutDisplayFunc(display);
@@ -5,6 +5,12 @@
 #include <ctime>
 #include <iostream>
 #include <vector>
+
+#include "../headless.cpp"
+#include "../sdf.cpp"
+#include "../text.cpp"
+// Con -DSCENE_MODULE solo queda el juego, para ./build/gallery (scenemodule.cpp)
+#include "../scenemodule.h"
 #ifdef _WIN32
 #include <windows.h>
 #endif
@@ -54,6 +60,11 @@ bool gamePaused = false;
 // --- Funciones auxiliares ---
 void drawCircle(float cx, float cy, float r, int num_segments, float colR, float colG, float colB)
 {
+    if (num_segments >= SDF_MIN_SEGMENTS && sdfAvailable()) {
+        float RGB[3] = { colR, colG, colB };
+        drawSdfEllipse(cx, cy, r, r, RGB);
+        return;
+    }
     glColor3f(colR, colG, colB);
     glBegin(GL_POLYGON);
     for (int ii = 0; ii < num_segments; ii++) {
@@ -67,11 +78,9 @@ void drawCircle(float cx, float cy, float r, int num_segments, float colR, float
 
 void drawText(float x, float y, const char* string, float colR, float colG, float colB)
 {
+    // Atlas de glifos (text.cpp): tambien funciona en modo headless
     glColor3f(colR, colG, colB);
-    glRasterPos2f(x, y);
-    for (const char* c = string; *c != '\0'; c++) {
-        glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, *c);
-    }
+    drawAtlasText(TEXT_HELVETICA_18, x, y, string);
 }
 
 // --- Logica del juego ---
@@ -117,7 +126,7 @@ void resetGame()
     snakeDirection = { MOVE_STEP, 0.0f };
 
     spawnApple();
-    glutPostRedisplay();
+    requestRedisplay();
 }
 
 // --- Logica de colisiones ---
@@ -129,11 +138,13 @@ bool checkCircleCollision(Point p1, float r1, Point p2, float r2)
     return distance < (r1 + r2 - MOVE_STEP * 0.1f);
 }
 
-// --- Funciones de GLUT ---
-void display()
+// --- Dibujado ---
+void drawShape()
 {
-    glClear(GL_COLOR_BUFFER_BIT);
-    glLoadIdentity();
+    // Color y grosor directos: los que conoce la cache de estado (glstate.cpp) vuelven al terminar.
+    // Lineas sin suavizar, como las deja initGL(), tambien dentro de ./build/gallery
+    glPushAttrib(GL_CURRENT_BIT | GL_LINE_BIT | GL_ENABLE_BIT);
+    glDisable(GL_LINE_SMOOTH);
 
     // Borde del escenario
     glColor3f(0.3f, 0.3f, 0.3f);
@@ -173,7 +184,19 @@ void display()
         drawText(SCENARIO_MIN_X + 0.02f, SCENARIO_MIN_Y - 0.08f, "P: Pausar, Q: Salir", 0.7f, 0.7f, 0.7f);
     }
 
-    glutSwapBuffers();
+    glPopAttrib();
+}
+
+#ifndef SCENE_MODULE
+// --- Funciones de GLUT ---
+void display()
+{
+    glClear(GL_COLOR_BUFFER_BIT);
+    glLoadIdentity();
+
+    drawShape();
+
+    presentFrame();
 }
 
 void reshape(GLsizei width, GLsizei height)
@@ -196,6 +219,7 @@ void reshape(GLsizei width, GLsizei height)
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
 }
+#endif // SCENE_MODULE
 
 void keyboard(unsigned char key, int x, int y)
 {
@@ -210,7 +234,7 @@ void keyboard(unsigned char key, int x, int y)
     case 'P':
         if (!gameOver && !victoryAchieved) {
             gamePaused = !gamePaused;
-            glutPostRedisplay();
+            requestRedisplay();
         }
         break;
     case 'q':
@@ -267,14 +291,14 @@ void updateGameLogic()
     // Calcular colisiones
     if (newHead.x < SCENARIO_MIN_X || newHead.x > SCENARIO_MAX_X || newHead.y < SCENARIO_MIN_Y || newHead.y > SCENARIO_MAX_Y) {
         gameOver = true;
-        glutPostRedisplay();
+        requestRedisplay();
         return;
     }
 
     for (size_t i = 0; i < snake.size(); ++i) {
         if (snake[i] == newHead) {
             gameOver = true;
-            glutPostRedisplay();
+            requestRedisplay();
             return;
         }
     }
@@ -287,7 +311,7 @@ void updateGameLogic()
         score++;
         if (score >= WIN_SCORE) {
             victoryAchieved = true;
-            glutPostRedisplay();
+            requestRedisplay();
             return;
         }
         spawnApple();
@@ -295,9 +319,36 @@ void updateGameLogic()
         snake.pop_back();
     }
 
-    glutPostRedisplay();
+    requestRedisplay();
 }
 
+#ifdef SCENE_MODULE
+// Lo que main() le da a GLUT, para el host (scenemodule.h)
+SCENE_EXPORT const float sceneViewExtent = 1.0f;
+SCENE_EXPORT const float sceneBackground[3] = { 0.1f, 0.1f, 0.15f };
+SCENE_EXPORT const int sceneTimerMs = TIMER_DELAY_MS;
+
+SCENE_EXPORT void sceneInit()
+{
+    srand(static_cast<unsigned int>(time(0)));
+    resetGame();
+}
+
+SCENE_EXPORT void sceneKeyboard(unsigned char key)
+{
+    keyboard(key, 0, 0);
+}
+
+SCENE_EXPORT void sceneSpecialKey(int key)
+{
+    specialKeys(key, 0, 0);
+}
+
+SCENE_EXPORT void sceneTimer()
+{
+    updateGameLogic();
+}
+#else
 void timer(int value)
 {
     updateGameLogic();
@@ -309,18 +360,28 @@ void initGL()
     glClearColor(0.1f, 0.1f, 0.15f, 1.0f);
 }
 
+void initGame()
+{
+    initGL();
+    resetGame();
+}
+
 int main(int argc, char** argv)
 {
     srand(static_cast<unsigned int>(time(0)));
 
+    HeadlessOptions headless;
+    if (parseHeadlessArgs(argc, argv, headless)) {
+        return runHeadless(headless, initGame, display, reshape);
+    }
+
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB);
     glutInitWindowSize(700, 700);
     glutInitWindowPosition(100, 100);
     glutCreateWindow("La serpiente (Solo 6 puntos, 20 es mucho)");
 
-    initGL();
-    resetGame();
+    initGame();
 
     glutDisplayFunc(display);
     glutReshapeFunc(reshape);
@@ -337,3 +398,4 @@ int main(int argc, char** argv)
     glutMainLoop();
     return 0;
 }
+#endif // SCENE_MODULE
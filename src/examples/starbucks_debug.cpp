@@ -12,8 +12,10 @@
 #define M_PI 3.14159265
 #endif
 
+#include "../headless.cpp"
+
 // DEBUG
-#include "debug.cpp"
+#include "../debug.cpp"
 
 // --- Estructuras ---
 
@@ -75,7 +77,7 @@ Figure pointsToFigure(std::vector<Point> points)
 
 void draw(DrawMode mode, Figure fig, float w = 3, ColorRGB c = BLACK)
 {
-    glColor3f(c.r, c.g, c.b);
+    stateColor3f(c.r, c.g, c.b);
 
     switch (mode) {
     case AREA:
@@ -86,11 +88,11 @@ void draw(DrawMode mode, Figure fig, float w = 3, ColorRGB c = BLACK)
         glVertex2f(0, 0);
         break;
     case BORDER:
-        glLineWidth(w);
+        stateLineWidth(w);
         glBegin(GL_LINE_STRIP);
         break;
     case POINTS:
-        glPointSize(w);
+        statePointSize(w);
         glBegin(GL_POINTS);
         break;
     }
@@ -99,8 +101,6 @@ void draw(DrawMode mode, Figure fig, float w = 3, ColorRGB c = BLACK)
         glVertex2f(fig.X[i], fig.Y[i]);
     }
     glEnd();
-    glLineWidth(1.0f);
-    glPointSize(1.0f);
 }
 
 void drawWithTrans(DrawMode mode, Figure fig, float cx, float cy, float w = 3,
@@ -623,12 +623,9 @@ void drawShape()
 
 // --- Funciones de GLUT ---
 
-void display(void)
+// Capa estatica: se guarda en cache entre eventos del raton (compositor.cpp)
+void drawScene()
 {
-    glClear(GL_COLOR_BUFFER_BIT);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
     // DEBUG
     if (debug) {
         drawImageReference();
@@ -640,13 +637,26 @@ void display(void)
     // DEBUG
     if (debug) {
         drawAxes(1.1f, 1.5f);
+    }
+}
+
+void display(void)
+{
+    glClear(GL_COLOR_BUFFER_BIT);
+    stateBlend(true);
+    stateBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    drawStaticLayer(drawScene);
+
+    // DEBUG: overlay, redibujado en cada evento del raton
+    if (debug) {
         drawCoordinatesText();
         drawBezierDebug();
+        drawStateCounters();
     }
 
-    glDisable(GL_BLEND);
-
-    glutSwapBuffers();
+    presentFrame();
+    endOverlayFrame();
 }
 
 void reshape(int w, int h)
@@ -670,22 +680,32 @@ void reshape(int w, int h)
     glLoadIdentity();
 }
 
+void init()
+{
+    // DEBUG
+    loadTexture("star.png");
+
+    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+    glEnable(GL_LINE_SMOOTH);
+    glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
+}
+
 int main(int argc, char* argv[])
 {
+    HeadlessOptions headless;
+    bool offscreen = parseHeadlessArgs(argc, argv, headless);
+    parseEditorArgs(argc, argv);
+    if (offscreen) {
+        return runHeadless(headless, init, display, reshape);
+    }
+
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_RGBA | GLUT_DOUBLE | GLUT_DEPTH);
     glutInitWindowSize(600, 600);
     glutInitWindowPosition(100, 100);
     glutCreateWindow("Starbucks");
 
-    // Init
-
-    // DEBUG
-    loadTexture("star.png");
-
-    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
-    glEnable(GL_LINE_SMOOTH);
-    glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
+    init();
 
     // Register GLUT callbacks
     glutDisplayFunc(display);
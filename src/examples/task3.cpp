@@ -9,9 +9,15 @@
 #include <GL/glut.h>
 #endif
 
+#include <chrono>
 #include <cstdlib>
+#include <cstring>
+#include <iostream>
 #include <math.h>
 #include <stdlib.h>
+#include <vector>
+
+#include "../headless.cpp"
 #define PI 3.141592653589793f
 
 float amarillo[3] = { 1, 1, 0 },
@@ -131,6 +137,183 @@ void cardioide_sector_2(
     glEnd();
 }
 
+// --- Curvas polares especializadas ---
+// Version sin ramas de cardioide_sector / cardioide_sector_2: la curva y la
+// primitiva se fijan en compilacion, y seno/coseno se avanzan por rotacion
+// incremental en vez de llamar a sinf/cosf en cada vertice.
+
+typedef enum {
+    SENO, // r = a - b*sin(m*t)
+    COSENO, // r = a - b*cos(m*t)
+    CARDIOIDE // r = 1 - cos(t), escalada por (a, b)
+} Curva;
+
+// Rotacion incremental de (cos, sin) en un paso fijo
+struct Giro {
+    float c, s, dc, ds;
+    Giro(float t0, float paso)
+        : c(cosf(t0))
+        , s(sinf(t0))
+        , dc(cosf(paso))
+        , ds(sinf(paso))
+    {
+    }
+    inline void avanzar()
+    {
+        float nc = c * dc - s * ds;
+        s = s * dc + c * ds;
+        c = nc;
+    }
+};
+
+template <Curva C>
+struct CurvaPolar;
+
+template <>
+struct CurvaPolar<SENO> {
+    static inline void punto(const Giro& t, const Giro& mt, float a, float b, float& vx, float& vy)
+    {
+        float r = a - b * mt.s;
+        vx = r * t.c;
+        vy = r * t.s;
+    }
+};
+
+template <>
+struct CurvaPolar<COSENO> {
+    static inline void punto(const Giro& t, const Giro& mt, float a, float b, float& vx, float& vy)
+    {
+        float r = a - b * mt.c;
+        vx = r * t.c;
+        vy = r * t.s;
+    }
+};
+
+template <>
+struct CurvaPolar<CARDIOIDE> {
+    static inline void punto(const Giro& t, const Giro&, float a, float b, float& vx, float& vy)
+    {
+        float r = 1 - t.c;
+        vx = a * r * t.c;
+        vy = b * r * t.s;
+    }
+};
+
+// Buffer de vertices reutilizado entre llamadas
+std::vector<float> verticesCurva;
+
+// Genera los vertices (x, y intercalados) de la curva en out
+template <Curva C, GLenum Modo>
+void generarCurva(
+    std::vector<float>& out,
+    float x, float y,
+    float a, float b,
+    float t1, float t2,
+    float m,
+    int segmentos)
+{
+    const bool conCentro = Modo == GL_POLYGON || Modo == GL_TRIANGLE_FAN;
+    out.resize(2 * (segmentos + 1 + (conCentro ? 1 : 0)));
+    float* v = out.data();
+    if (conCentro) {
+        *v++ = x;
+        *v++ = y;
+    }
+
+    float paso = (t2 - t1) / segmentos;
+    Giro t(t1, paso);
+    Giro mt(t1 * m, paso * m);
+    for (int i = 0; i <= segmentos; i++) {
+        float vx, vy;
+        CurvaPolar<C>::punto(t, mt, a, b, vx, vy);
+        *v++ = x + vx;
+        *v++ = y + vy;
+        t.avanzar();
+        if (C != CARDIOIDE) {
+            mt.avanzar();
+        }
+    }
+}
+
+template <Curva C, GLenum Modo>
+void curvaPolar(
+    float x, float y,
+    float a, float b,
+    float t1, float t2,
+    float m,
+    float* RGB,
+    int segmentos = 100)
+{
+    generarCurva<C, Modo>(verticesCurva, x, y, a, b, t1, t2, m, segmentos);
+
+    glColor3fv(RGB);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 0, verticesCurva.data());
+    glDrawArrays(Modo, 0, (GLsizei)(verticesCurva.size() / 2));
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+// --- Microbenchmark ---
+// ./task3 --bench [iteraciones]: compara cardioide_sector/cardioide_sector_2
+// con curvaPolar dibujando las curvas del logo, y mide aparte el costo de
+// generar los vertices.
+
+template <typename F>
+double medir(int iteraciones, F f)
+{
+    glFinish();
+    auto inicio = std::chrono::steady_clock::now();
+    for (int i = 0; i < iteraciones; i++) {
+        f();
+    }
+    glFinish();
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - inicio).count() / iteraciones;
+}
+
+void benchmark(int iteraciones)
+{
+    float A = 0.7, B = 0.4;
+    volatile float sumidero = 0;
+
+    // Solo la generacion de vertices de la version especializada
+    double nuevoCPU = medir(iteraciones, [&]() {
+        generarCurva<SENO, GL_POLYGON>(verticesCurva, 0, -B, 0, -A / 2, -PI / 2, 0, 2, 100);
+        sumidero = sumidero + verticesCurva[2];
+    });
+
+    // Dibujando las seis curvas del logo
+    auto viejo = [&]() {
+        cardioide_sector(0, -B, 0, -A / 2, -PI / 2, 0, 2, 1, GL_POLYGON, amarillo);
+        cardioide_sector(-0.225, -0.4, 0, -A * 0.515, -PI / 2, 0, 2, 1, GL_POLYGON, amarillo);
+        cardioide_sector(0, -B, 0, -A / 2, 0, PI / 2, 2, 1, GL_POLYGON, amarillo);
+        cardioide_sector(0.225, -0.4, 0, -A * 0.515, 0, PI / 2, 2, 1, GL_POLYGON, amarillo);
+        cardioide_sector_2(-0.12, 0.4, 0.12, 0.2, PI + PI / 28, 25 * PI / 12, GL_POLYGON, amarillo);
+        cardioide_sector_2(0.12, 0.4, -0.12, 0.2, 29 * PI / 28, 25 * PI / 12, GL_POLYGON, amarillo);
+    };
+    auto nuevo = [&]() {
+        curvaPolar<SENO, GL_POLYGON>(0, -B, 0, -A / 2, -PI / 2, 0, 2, amarillo);
+        curvaPolar<SENO, GL_POLYGON>(-0.225, -0.4, 0, -A * 0.515, -PI / 2, 0, 2, amarillo);
+        curvaPolar<SENO, GL_POLYGON>(0, -B, 0, -A / 2, 0, PI / 2, 2, amarillo);
+        curvaPolar<SENO, GL_POLYGON>(0.225, -0.4, 0, -A * 0.515, 0, PI / 2, 2, amarillo);
+        curvaPolar<CARDIOIDE, GL_POLYGON>(-0.12, 0.4, 0.12, 0.2, PI + PI / 28, 25 * PI / 12, 1, amarillo);
+        curvaPolar<CARDIOIDE, GL_POLYGON>(0.12, 0.4, -0.12, 0.2, 29 * PI / 28, 25 * PI / 12, 1, amarillo);
+    };
+    double viejoGL = medir(iteraciones, viejo);
+    double nuevoGL = medir(iteraciones, nuevo);
+
+    // Sin rasterizar, para ver solo el envio de vertices
+    glEnable(GL_RASTERIZER_DISCARD);
+    double viejoEnvio = medir(iteraciones, viejo);
+    double nuevoEnvio = medir(iteraciones, nuevo);
+    glDisable(GL_RASTERIZER_DISCARD);
+
+    std::cout << "Generacion (1 curva, 102 vertices): curvaPolar " << nuevoCPU << " us" << std::endl;
+    std::cout << "Dibujado (6 curvas del logo): cardioide_sector " << viejoGL
+              << " us, curvaPolar " << nuevoGL << " us" << std::endl;
+    std::cout << "Envio sin rasterizar (6 curvas): cardioide_sector " << viejoEnvio
+              << " us, curvaPolar " << nuevoEnvio << " us" << std::endl;
+}
+
 void display(void)
 {
     glClearColor(1, 1, 1, 1);
@@ -141,12 +324,12 @@ void display(void)
     elipse(0, 0, 0.75, 0.45, amarillo, negro, 6);
     elipse(0, 0, A, B, negro, negro);
 
-    cardioide_sector(0, -B, 0, -A / 2, -PI / 2, 0, 2, 1, GL_POLYGON, amarillo);
-    cardioide_sector(-0.225, -0.4, 0, -A * 0.515, -PI / 2, 0, 2, 1, GL_POLYGON, amarillo);
-    cardioide_sector(0, -B, 0, -A / 2, 0, PI / 2, 2, 1, GL_POLYGON, amarillo);
-    cardioide_sector(0.225, -0.4, 0, -A * 0.515, 0, PI / 2, 2, 1, GL_POLYGON, amarillo);
-    cardioide_sector_2(-0.12, 0.4, 0.12, 0.2, PI + PI / 28, 25 * PI / 12, GL_POLYGON, amarillo);
-    cardioide_sector_2(0.12, 0.4, -0.12, 0.2, 29 * PI / 28, 25 * PI / 12, GL_POLYGON, amarillo);
+    curvaPolar<SENO, GL_POLYGON>(0, -B, 0, -A / 2, -PI / 2, 0, 2, amarillo);
+    curvaPolar<SENO, GL_POLYGON>(-0.225, -0.4, 0, -A * 0.515, -PI / 2, 0, 2, amarillo);
+    curvaPolar<SENO, GL_POLYGON>(0, -B, 0, -A / 2, 0, PI / 2, 2, amarillo);
+    curvaPolar<SENO, GL_POLYGON>(0.225, -0.4, 0, -A * 0.515, 0, PI / 2, 2, amarillo);
+    curvaPolar<CARDIOIDE, GL_POLYGON>(-0.12, 0.4, 0.12, 0.2, PI + PI / 28, 25 * PI / 12, 1, amarillo);
+    curvaPolar<CARDIOIDE, GL_POLYGON>(0.12, 0.4, -0.12, 0.2, 29 * PI / 28, 25 * PI / 12, 1, amarillo);
 
     // Correcciones xD
     elipse(-0.2, -0.33, 0.08, 0.08, amarillo, amarillo);
@@ -164,7 +347,7 @@ void display(void)
     glVertex2f(0.12, 0.41);
     glEnd();
 
-    glutSwapBuffers();
+    presentFrame();
 }
 
 void inicio()
@@ -177,6 +360,11 @@ void inicio()
 
 int main(int argc, char* argv[])
 {
+    HeadlessOptions headless;
+    if (parseHeadlessArgs(argc, argv, headless)) {
+        return runHeadless(headless, inicio, display, NULL);
+    }
+
     glutInit(&argc, argv);
     glutInitWindowSize(800, 800);
     glutInitWindowPosition(500, 10);
@@ -184,6 +372,12 @@ int main(int argc, char* argv[])
 
     glutCreateWindow("Logo Batman");
     inicio();
+
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        benchmark(argc > 2 ? atoi(argv[2]) : 2000);
+        return EXIT_SUCCESS;
+    }
+
     glutDisplayFunc(display);
     glutMainLoop();
 
@@ -0,0 +1,473 @@
+#pragma once
+
+#include "figure.h"
+
+// Un modulo de escena (host.cpp) usa las definiciones del host
+#ifndef SCENE_MODULE
+
+#include <GL/glut.h>
+#include <climits>
+#include <cmath>
+#include <map>
+#include <math.h>
+#include <stdexcept>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "glstate.cpp"
+#include "gpubezier.cpp"
+#include "layered.cpp"
+#include "loopblinn.cpp"
+#include "modern.cpp"
+#include "pathasset.cpp"
+#include "sdf.cpp"
+#include "softraster.cpp"
+
+// --- Constantes ---
+
+int SEGMENTS = 100;
+ColorRGB WHITE = { 1.0f, 1.0f, 1.0f };
+ColorRGB BLACK = { 0.0f, 0.0f, 0.0f };
+ColorRGB RED = { 1.0f, 0.0f, 0.0f };
+ColorRGB GREEN = { 0.0f, 1.0f, 0.0f };
+ColorRGB BLUE = { 0.0f, 0.0f, 1.0f };
+ColorRGB ORANGE = { 0.8f, 0.5f, 0.2f };
+ColorRGB YELLOW = { 1.0f, 1.0f, 0.0f };
+
+// --- Funciones auxiliares ---
+
+Figure newFigure(std::vector<float>& X, std::vector<float>& Y)
+{
+    if (X.size() != Y.size()) {
+        throw std::invalid_argument("the sizes do not match");
+    }
+    return { X, Y, X.size(), {} };
+}
+
+Figure pointsToFigure(std::vector<Point> points)
+{
+    std::vector<float> X(points.size());
+    std::vector<float> Y(points.size());
+    for (size_t i = 0; i < points.size(); i++) {
+        X[i] = points[i].x;
+        Y[i] = points[i].y;
+    }
+    return newFigure(X, Y);
+}
+
+// --- Funciones de dibujado ---
+
+// --- Opciones ---
+
+// Como dibuja draw(): --modern/--core, --bezier y, con --soft, --fill, --aa
+// y --threads. Cada modulo lee las suyas.
+void parseFigureArgs(int argc, char* argv[])
+{
+    parseModernArgs(argc, argv);
+    parseBezierArgs(argc, argv);
+    parseSoftArgs(argc, argv);
+}
+
+// --- Transformaciones ---
+// La pila de matrices de GL, o la de CPU en modo software y moderno
+
+// Reemplaza a gluOrtho2D en reshape()
+void ortho2D(float left, float right, float bottom, float top)
+{
+    modernOrtho2D(left, right, bottom, top);
+    softLoadIdentity();
+    if (!g_CoreProfile) {
+        glMatrixMode(GL_PROJECTION);
+        glLoadIdentity();
+        gluOrtho2D(left, right, bottom, top);
+        glMatrixMode(GL_MODELVIEW);
+        glLoadIdentity();
+    }
+}
+
+void pushMatrix()
+{
+    if (g_SoftMode || g_ModernMode)
+        softPushMatrix();
+    else
+        glPushMatrix();
+}
+
+void popMatrix()
+{
+    if (g_SoftMode || g_ModernMode)
+        softPopMatrix();
+    else
+        glPopMatrix();
+}
+
+void translate2D(float x, float y)
+{
+    if (g_SoftMode || g_ModernMode)
+        softTranslate(x, y);
+    else
+        glTranslatef(x, y, 0.0f);
+}
+
+void rotate2D(float degrees)
+{
+    if (g_SoftMode || g_ModernMode)
+        softRotate(degrees);
+    else
+        glRotatef(degrees, 0.0f, 0.0f, 1.0f);
+}
+
+void scale2D(float x, float y)
+{
+    if (g_SoftMode || g_ModernMode)
+        softScale(x, y);
+    else
+        glScalef(x, y, 1.0f);
+}
+
+// Curvas de genBezier en la GPU a partir de sus puntos de control (x, y):
+// rellenos con Loop-Blinn o teselados, bordes teselados. Devuelve false si
+// hay que dibujar la figura aplanada en la CPU.
+bool drawBezierControls(DrawMode mode, const std::vector<float>& controls, float w, ColorRGB c)
+{
+    if (mode == POINTS) {
+        return false;
+    }
+    float ox = mode == AREAFIX ? 0.0f : controls[0];
+    float oy = mode == AREAFIX ? 0.0f : controls[1];
+    if (mode != BORDER && loopBlinnAvailable()) {
+        loopBlinnFill(c.r, c.g, c.b, controls, ox, oy);
+        return true;
+    }
+    if (gpuBezierAvailable()) {
+        gpuBezierSubmit(mode != BORDER, w, c.r, c.g, c.b, controls, ox, oy);
+        return true;
+    }
+    return false;
+}
+
+void draw(DrawMode mode, const Figure& fig, float w, ColorRGB c)
+{
+    if (g_SoftMode) {
+        SoftPrimitive primitive = SOFT_POLYGON;
+        if (mode == BORDER) {
+            primitive = SOFT_LINE_STRIP;
+        } else if (mode == POINTS) {
+            primitive = SOFT_POINTS;
+        }
+        softSubmit(primitive, w, c.r, c.g, c.b, fig.X, fig.Y, fig.size, mode == AREAFIX);
+        return;
+    }
+    if (g_ModernMode) {
+        GLenum primitive = GL_TRIANGLE_FAN; // GL_POLYGON no existe en core
+        if (mode == BORDER) {
+            primitive = GL_LINE_STRIP;
+        } else if (mode == POINTS) {
+            primitive = GL_POINTS;
+        }
+        modernSubmit(primitive, w, c.r, c.g, c.b, fig.X, fig.Y, fig.size, mode == AREAFIX);
+        return;
+    }
+    if (g_LayeredMode) {
+        GLenum primitive = GL_POLYGON;
+        if (mode == BORDER) {
+            primitive = GL_LINE_STRIP;
+        } else if (mode == POINTS) {
+            primitive = GL_POINTS;
+        }
+        bool opaque = mode == AREA || mode == AREAFIX;
+        layeredSubmit(primitive, opaque, w, c.r, c.g, c.b, fig.X, fig.Y, fig.size, mode == AREAFIX);
+        return;
+    }
+    if (!fig.bezier.empty() && drawBezierControls(mode, fig.bezier, w, c)) {
+        return;
+    }
+
+    stateColor3f(c.r, c.g, c.b);
+
+    switch (mode) {
+    case AREA:
+        glBegin(GL_POLYGON);
+        break;
+    case AREAFIX:
+        glBegin(GL_POLYGON);
+        glVertex2f(0, 0);
+        break;
+    case BORDER:
+        stateLineWidth(w);
+        glBegin(GL_LINE_STRIP);
+        break;
+    case POINTS:
+        statePointSize(w);
+        glBegin(GL_POINTS);
+        break;
+    }
+
+    for (size_t i = 0; i < fig.size; i++) {
+        glVertex2f(fig.X[i], fig.Y[i]);
+    }
+    glEnd();
+}
+
+void drawWithTrans(DrawMode mode, const Figure& fig, float cx, float cy, float w,
+    ColorRGB c)
+{
+    pushMatrix();
+    translate2D(cx, cy);
+    draw(mode, fig, w, c);
+    popMatrix();
+}
+
+void drawWithRotate(DrawMode mode, const Figure& fig, float angle, float w, ColorRGB c)
+{
+    pushMatrix();
+    rotate2D(angle);
+    draw(mode, fig, w, c);
+    popMatrix();
+}
+
+void drawWithScale(DrawMode mode, const Figure& fig, float scaleX, float scaleY, float w, ColorRGB c)
+{
+    pushMatrix();
+    scale2D(scaleX, scaleY);
+    draw(mode, fig, w, c);
+    popMatrix();
+}
+
+void drawWithTransScale(DrawMode mode, const Figure& fig, float cx, float cy, float scaleX, float scaleY, float w, ColorRGB c)
+{
+    pushMatrix();
+    translate2D(cx, cy);
+    scale2D(scaleX, scaleY);
+    draw(mode, fig, w, c);
+    popMatrix();
+}
+
+void drawFlower(DrawMode mode, const Figure& fig, int n, float r, float scaleX, float scaleY, bool skip, float w, ColorRGB c)
+{
+    float t1 = 0.0;
+    if (skip)
+        t1 = M_PI / n;
+    for (int i = 0; i < n; i++) {
+        pushMatrix();
+        float theta = 2 * M_PI * i / n + t1;
+        translate2D(r * cosf(theta), r * sinf(theta));
+        rotate2D(theta * 180.0f / M_PI);
+        scale2D(scaleX, scaleY);
+        draw(mode, fig, w, c);
+        popMatrix();
+    }
+}
+
+// --- Figuras comunes ---
+
+Point getBezierPoint(Point p0, Point p1, Point p2, float t)
+{
+    Point p;
+    float u = 1.0f - t;
+    float tt = t * t;
+    float uu = u * u;
+    float u2t = 2.0f * u * t;
+
+    p.x = uu * p0.x + u2t * p1.x + tt * p2.x;
+    p.y = uu * p0.y + u2t * p1.y + tt * p2.y;
+
+    return p;
+}
+
+Figure genBezier(const std::vector<Point> points)
+{
+    if (points.size() < 3 || points.size() % 2 == 0) {
+        return Figure {};
+    }
+    int n = SEGMENTS;
+    int k = (points.size() - 1) / 2;
+    std::vector<float> X(k * n + 1);
+    std::vector<float> Y(k * n + 1);
+    X[0] = points[0].x;
+    Y[0] = points[0].y;
+    for (size_t i = 0; i < points.size() - 1; i += 2) {
+        Point p0 = points[i];
+        Point p1 = points[i + 1];
+        Point p2 = points[i + 2];
+
+        for (int j = 1; j <= n; ++j) {
+            float t = (float)j / n;
+            Point p = getBezierPoint(p0, p1, p2, t);
+            int l = n * (i / 2) + j;
+            X[l] = p.x;
+            Y[l] = p.y;
+        }
+    }
+    Figure fig = newFigure(X, Y);
+    for (const Point& p : points) {
+        fig.bezier.push_back(p.x);
+        fig.bezier.push_back(p.y);
+    }
+    return fig;
+}
+
+// genBezier del camino llamado name en el archivo de la escena (pathasset.cpp),
+// o de defaults si el archivo no lo tiene. Solo se vuelve a generar cuando el
+// camino cambia en el archivo, asi que se puede llamar en cada cuadro.
+typedef struct {
+    Figure fig;
+    unsigned generation; // 0: defaults
+} PathFigure;
+
+std::map<std::string, PathFigure> g_PathFigures;
+
+const Figure& pathFigure(const char* name, const std::vector<Point>& defaults)
+{
+    static_assert(sizeof(Point) == 2 * sizeof(float), "Point debe ser un par x, y");
+    auto it = g_PathFigures.find(name);
+    if (it == g_PathFigures.end()) {
+        setPathDefault(name, (const float*)defaults.data(), defaults.size()); // Para el editor
+        it = g_PathFigures.insert({ name, { Figure {}, UINT_MAX } }).first;
+    }
+    const PathAsset* path = findPathAsset(name);
+    unsigned generation = path ? path->generation : 0;
+    if (it->second.generation != generation) {
+        it->second.generation = generation;
+        if (path) {
+            const Point* points = (const Point*)path->xy;
+            it->second.fig = genBezier(std::vector<Point>(points, points + path->count));
+        } else {
+            it->second.fig = genBezier(defaults);
+        }
+    }
+    return it->second.fig;
+}
+
+// Los defaults pueden haber cambiado: un modulo de escena nuevo (host.cpp)
+void forgetPathFigures()
+{
+    g_PathFigures.clear();
+}
+
+// Igual que draw(mode, genBezier(points), ...), pero sin teselar en la CPU
+// cuando la GPU evalua las curvas
+void drawBezier(DrawMode mode, const std::vector<Point>& points, float w, ColorRGB c)
+{
+    bool gpu = (g_GpuBezier || g_LoopBlinn) && !g_SoftMode && !g_ModernMode && !g_LayeredMode;
+    if (gpu && points.size() >= 3 && points.size() % 2 == 1) {
+        static std::vector<float> controls;
+        controls.clear();
+        for (const Point& p : points) {
+            controls.push_back(p.x);
+            controls.push_back(p.y);
+        }
+        if (drawBezierControls(mode, controls, w, c)) {
+            return;
+        }
+    }
+    draw(mode, genBezier(points), w, c);
+}
+
+Figure genPoly(int n, bool skip)
+{
+    float t1 = 0.0;
+    if (skip)
+        t1 = -M_PI / 2 - M_PI / n;
+    std::vector<float> X(n + 1);
+    std::vector<float> Y(n + 1);
+    for (int i = 0; i < n + 1; i++) {
+        float t = 2 * M_PI * i / n;
+        X[i] = cosf(t + t1);
+        Y[i] = sinf(t + t1);
+    }
+    return newFigure(X, Y);
+}
+
+Figure genCircle(float t1, float t2)
+{
+    int n = SEGMENTS;
+    std::vector<float> X(n);
+    std::vector<float> Y(n);
+    for (int i = 0; i < n; i++) {
+        float t = t1 + (t2 - t1) * i / (n - 1);
+        X[i] = cosf(t);
+        Y[i] = sinf(t);
+    }
+    return newFigure(X, Y);
+}
+
+// Elipse de radios (rx, ry) en (cx, cy). Con el shader SDF es un solo quad con
+// bordes suavizados; si no, se dibuja el circulo poligonal escalado.
+void drawEllipse(DrawMode mode, float cx, float cy, float rx, float ry, float w, ColorRGB c)
+{
+    if (!g_SoftMode && !g_ModernMode && !g_LayeredMode && (mode == AREA || mode == BORDER) && sdfAvailable()) {
+        float RGB[3] = { c.r, c.g, c.b };
+        drawSdfEllipse(cx, cy, rx, ry, RGB, mode == BORDER ? w : 0.0f);
+        return;
+    }
+    static Figure circle = genCircle();
+    drawWithTransScale(mode, circle, cx, cy, rx, ry, w, c);
+}
+
+Figure genHoja()
+{
+    int n = SEGMENTS;
+    std::vector<float> X(2 * n);
+    std::vector<float> Y(2 * n);
+    for (int i = 0; i < n; i++) {
+        float t = -1.0 + 2.0 * i / (n - 1);
+        X[i] = t;
+        Y[i] = sinf(M_PI * (t + 1) / 2);
+    }
+    for (int i = 0; i < n; i++) {
+        float t = -1.0 + 2.0 * i / (n - 1);
+        X[n + i] = -t;
+        Y[n + i] = -sinf(M_PI * (t + 1) / 2);
+    }
+    return newFigure(X, Y);
+}
+
+Figure genCardoid(float t1, float t2)
+{
+    int n = SEGMENTS;
+    float a = 0.5;
+    std::vector<float> X(n);
+    std::vector<float> Y(n);
+    for (int i = 0; i < n; i++) {
+        float t = t1 + (t2 - t1) * i / (n - 1);
+        X[i] = (a - a * sinf(t)) * cosf(t);
+        Y[i] = (a - a * sinf(t)) * sinf(t);
+    }
+    return newFigure(X, Y);
+}
+
+Figure genRose(int k, bool skip, float t1, float t2)
+{
+    int n = SEGMENTS;
+    std::vector<float> X(n);
+    std::vector<float> Y(n);
+    for (int i = 0; i < n; i++) {
+        float t = t1 + (t2 - t1) * i / (n - 1);
+        if (skip) {
+            X[i] = sinf(k * t) * cosf(t);
+            Y[i] = sinf(k * t) * sinf(t);
+        } else {
+            X[i] = cosf(k * t) * cosf(t);
+            Y[i] = cosf(k * t) * sinf(t);
+        }
+    }
+    return newFigure(X, Y);
+}
+
+Figure genLemniscate(float t1, float t2)
+{
+    int n = SEGMENTS;
+    float a = 1.0;
+    std::vector<float> X(n);
+    std::vector<float> Y(n);
+    for (int i = 0; i < n; i++) {
+        float t = t1 + (t2 - t1) * i / (n - 1);
+        X[i] = a * cosf(t) / (1 + pow(sinf(t), 2));
+        Y[i] = a * sinf(t) * cosf(t) / (1 + pow(sinf(t), 2));
+    }
+    return newFigure(X, Y);
+}
+
+#endif // SCENE_MODULE
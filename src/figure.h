@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+#ifndef M_PI
+#define M_PI 3.14159265
+#endif
+
+// Tipos y funciones de figure.cpp que usan las escenas. Un modulo de escena
+// (host.cpp) solo incluye esto: las definiciones, y el estado detras de
+// ellas, son las del host que lo carga.
+
+// --- Estructuras ---
+
+typedef struct {
+    std::vector<float> X;
+    std::vector<float> Y;
+    size_t size;
+    std::vector<float> bezier; // Puntos de control (x, y) si viene de genBezier
+} Figure;
+
+typedef struct {
+    float r, g, b;
+} ColorRGB;
+
+typedef enum {
+    AREA,
+    AREAFIX,
+    BORDER,
+    POINTS
+} DrawMode;
+
+typedef struct {
+    float x;
+    float y;
+} Point;
+
+// --- Constantes ---
+
+extern int SEGMENTS;
+extern ColorRGB WHITE, BLACK, RED, GREEN, BLUE, ORANGE, YELLOW;
+
+// --- Funciones ---
+
+Figure newFigure(std::vector<float>& X, std::vector<float>& Y);
+Figure pointsToFigure(std::vector<Point> points);
+
+void ortho2D(float left, float right, float bottom, float top);
+void pushMatrix();
+void popMatrix();
+void translate2D(float x, float y);
+void rotate2D(float degrees);
+void scale2D(float x, float y);
+
+void draw(DrawMode mode, const Figure& fig, float w = 3, ColorRGB c = BLACK);
+void drawWithTrans(DrawMode mode, const Figure& fig, float cx, float cy, float w = 3, ColorRGB c = BLACK);
+void drawWithRotate(DrawMode mode, const Figure& fig, float angle, float w = 3, ColorRGB c = BLACK);
+void drawWithScale(DrawMode mode, const Figure& fig, float scaleX, float scaleY, float w = 3, ColorRGB c = BLACK);
+void drawWithTransScale(DrawMode mode, const Figure& fig, float cx, float cy, float scaleX, float scaleY, float w = 3, ColorRGB c = BLACK);
+void drawFlower(DrawMode mode, const Figure& fig, int n, float r, float scaleX, float scaleY, bool skip = false, float w = 3, ColorRGB c = BLACK);
+
+Point getBezierPoint(Point p0, Point p1, Point p2, float t);
+Figure genBezier(const std::vector<Point> points);
+const Figure& pathFigure(const char* name, const std::vector<Point>& defaults);
+void drawBezier(DrawMode mode, const std::vector<Point>& points, float w = 3, ColorRGB c = BLACK);
+void drawEllipse(DrawMode mode, float cx, float cy, float rx, float ry, float w = 3, ColorRGB c = BLACK);
+
+Figure genPoly(int n, bool skip = false);
+Figure genCircle(float t1 = 0, float t2 = 2 * M_PI);
+Figure genHoja();
+Figure genCardoid(float t1 = 0, float t2 = 2 * M_PI);
+Figure genRose(int k, bool skip = false, float t1 = 0, float t2 = 2 * M_PI);
+Figure genLemniscate(float t1 = 0, float t2 = 2 * M_PI);
+
+// Lo que host.cpp busca con dlsym: sceneDrawShape(), que es el drawShape() de la escena
+#include "scenemodule.h"
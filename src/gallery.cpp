@@ -0,0 +1,380 @@
+#include <GL/glut.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "headless.cpp"
+
+// DEBUG
+#include "debug.cpp"
+
+#include "figure.cpp"
+#include "scenemodule.cpp"
+
+// SCENE GALLERY
+// make scenes build/gallery && ./build/gallery [--scene NAME] [--cycle FRAMES] [scene flags]
+// Every scene in one program, shown one at a time: 1-9 picks one of the
+// first nine, Tab shows the next. Each is a scene module (scenemodule.cpp)
+// drawing through the gallery's figure.cpp, disks.cpp, sdf.cpp and text.cpp,
+// so they all share its GL context, state cache, GPU Bezier caches and text
+// atlas, and the reference images stay cached in refimage.cpp. The
+// projection, background, keys and timer are the shown scene's
+// (scenemodule.h). A scene is loaded the first time it is shown and then
+// kept, along with its path assets and the Figures generated from them, so
+// showing it again costs about as much as any other frame.
+//
+// --cycle FRAMES shows each scene for FRAMES frames in turn, headless too
+// (--frames in all), and prints per scene the first frame of its first
+// visit, the median first frame of later visits and the median of the rest.
+
+typedef struct {
+    const char* name;
+    const char* module; // Built by make scenes
+    const char* image; // Reference image in debug mode, or NULL
+    const char* paths; // Path assets, or NULL
+    bool fixedFunction; // Not drawn through figure.cpp: nothing on --core
+} GalleryScene;
+
+const GalleryScene GALLERY_SCENES[] = {
+    { "main", "build/main.so", "problema12.png", "main.paths", false },
+    { "master", "build/master.so", "batman.png", "master.paths", false },
+    { "problema4", "build/problema4.so", NULL, NULL, false },
+    { "problema11", "build/problema11.so", NULL, NULL, false },
+    { "problema21", "build/problema21.so", NULL, NULL, false },
+    { "problema22", "build/problema22.so", NULL, NULL, false },
+    { "examples/batman", "build/examples/batman.so", NULL, NULL, false },
+    { "examples/mandala", "build/examples/mandala.so", NULL, NULL, false },
+    { "examples/starbucks", "build/examples/starbucks.so", NULL, NULL, false },
+    { "Pregunta1", "build/Pregunta1.so", NULL, NULL, true },
+    { "Pregunta2", "build/Pregunta2.so", NULL, NULL, true },
+    { "Pregunta3", "build/Pregunta3.so", NULL, NULL, true },
+    { "Pregunta4", "build/Pregunta4.so", NULL, NULL, true },
+    { "examples/serpiente", "build/examples/serpiente.so", NULL, NULL, true },
+};
+const int GALLERY_SIZE = sizeof(GALLERY_SCENES) / sizeof(GALLERY_SCENES[0]);
+
+// What a scene keeps while another one is shown: its module, path assets,
+// Figures and Bezier editor (debug.cpp) are swapped into g_SceneModule,
+// g_PathAssets, g_PathFigures and the editor's globals while it is the one
+// shown, so a path being edited is saved to its own scene's file
+typedef struct {
+    bool visited;
+    bool imageFailed; // Reported once, not retried
+    SceneModule module;
+    PathAssetFile assets;
+    std::map<std::string, PathFigure> figures;
+    bool bezierMode;
+    bool placingControlPoint;
+    std::vector<DebugPoint> bezierPoints; // Segment being placed
+    std::vector<DebugPoint> bezierPath; // Finalized path
+    PointGrid editorGrid;
+    std::vector<double> switches; // --cycle: first frame of each visit, ms
+    std::vector<double> frames; // --cycle: the other frames, ms
+} GalleryState;
+
+std::vector<GalleryState> g_Gallery;
+int g_Scene = -1; // Shown
+int g_NextScene = 0; // Shown from the next frame on
+int g_CycleFrames = 0; // --cycle FRAMES, 0 to stay on a scene
+int g_CycleFrame = 0; // Frames of this visit so far
+
+void swapSceneState(GalleryState& state)
+{
+    std::swap(g_SceneModule, state.module);
+    std::swap(g_PathAssets, state.assets);
+    std::swap(g_PathFigures, state.figures);
+    std::swap(g_BezierMode, state.bezierMode);
+    std::swap(g_PlacingControlPoint, state.placingControlPoint);
+    std::swap(g_CurrentBezierInteractivePoints, state.bezierPoints);
+    std::swap(g_FinalBezierPathPoints, state.bezierPath);
+    std::swap(g_EditorGrid, state.editorGrid);
+    // Picked under the cursor, in the path that was shown
+    g_HoverPoint = -1;
+    g_DragPoint = -1;
+}
+
+void reshape(int w, int h)
+{
+    glViewport(0, 0, (GLsizei)w, (GLsizei)h);
+
+    // Keep a 1:1 aspect ratio
+    float aspect = (float)w / (float)h;
+    float viewExtent = g_SceneModule.viewExtent;
+    if (w >= h) {
+        ortho2D(-viewExtent * aspect, viewExtent * aspect, -viewExtent, viewExtent);
+    } else {
+        ortho2D(-viewExtent, viewExtent, -viewExtent / aspect, viewExtent / aspect);
+    }
+}
+
+void showScene(int index)
+{
+    if (g_Scene >= 0) {
+        swapSceneState(g_Gallery[g_Scene]);
+    }
+    g_Scene = index;
+    const GalleryScene& scene = GALLERY_SCENES[index];
+    GalleryState& state = g_Gallery[index];
+    swapSceneState(state);
+
+    if (!state.visited) {
+        state.visited = true;
+        if (scene.paths) {
+            openPathAssets(scene.paths);
+            if (!g_Headless) {
+                watchPathAssetFile();
+            }
+        }
+        openSceneModule(scene.module);
+        if (scene.fixedFunction && g_CoreProfile) {
+            std::cerr << "ERROR: " << scene.name << " draws with fixed-function GL only; not shown with --core" << std::endl;
+        }
+    } else {
+        // Replaced or rebuilt while another scene was shown
+        pollPathAssets();
+        pollSceneModule();
+    }
+    if (!scene.image || state.imageFailed) {
+        clearRefImage();
+    } else if (!loadTexture(scene.image)) {
+        state.imageFailed = true;
+        clearRefImage();
+    }
+
+    // The scene's projection and background
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    reshape(viewport[2], viewport[3]);
+    const float* background = g_SceneModule.background;
+    glClearColor(background[0], background[1], background[2], 1.0f);
+    startSceneModuleTimer();
+    invalidateStaticLayer();
+    if (!g_Headless) {
+        glutSetWindowTitle(scene.name);
+    }
+}
+
+void drawShape()
+{
+    if (!GALLERY_SCENES[g_Scene].fixedFunction || !g_CoreProfile) {
+        drawSceneModule();
+    }
+}
+
+// Static layer: cached between mouse events (compositor.cpp)
+void drawScene()
+{
+    // DEBUG
+    if (debug) {
+        drawImageReference();
+    }
+
+    beginLayeredFrame();
+    drawShape();
+    endLayeredFrame();
+
+    // DEBUG
+    if (debug) {
+        drawAxes(1.1f, 1.5f);
+    }
+}
+
+void drawFrame()
+{
+    glClear(GL_COLOR_BUFFER_BIT);
+    stateBlend(true);
+    stateBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    // DEBUG
+    if (g_OverdrawMode) {
+        drawOverdraw(drawShape);
+        return;
+    }
+    drawStaticLayer(drawScene);
+
+    // DEBUG: overlay, redrawn on every mouse event
+    if (debug) {
+        drawCoordinatesText();
+        drawBezierDebug();
+        drawStateCounters();
+    }
+}
+
+double medianTime(std::vector<double> times)
+{
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+void printCycleStats()
+{
+    printf("%-20s %14s %14s %14s\n", "Scene", "first visit", "later visits", "other frames");
+    for (int i = 0; i < GALLERY_SIZE; i++) {
+        const GalleryState& state = g_Gallery[i];
+        if (state.switches.empty()) {
+            continue;
+        }
+        char later[32] = "-", frames[32] = "-";
+        if (state.switches.size() > 1) {
+            snprintf(later, sizeof(later), "%.3f ms", medianTime(std::vector<double>(state.switches.begin() + 1, state.switches.end())));
+        }
+        if (!state.frames.empty()) {
+            snprintf(frames, sizeof(frames), "%.3f ms", medianTime(state.frames));
+        }
+        printf("%-20s %11.3f ms %14s %14s\n", GALLERY_SCENES[i].name, state.switches[0], later, frames);
+    }
+    fflush(stdout);
+}
+
+// --cycle: times the frame and moves on to the next scene after FRAMES of them
+void cycleFrame(bool switched, double ms)
+{
+    GalleryState& state = g_Gallery[g_Scene];
+    if (switched) {
+        state.switches.push_back(ms);
+        g_CycleFrame = 0;
+    } else {
+        state.frames.push_back(ms);
+    }
+    if (++g_CycleFrame < g_CycleFrames) {
+        return;
+    }
+    g_NextScene = (g_Scene + 1) % GALLERY_SIZE;
+    if (g_NextScene == 0 && !g_Headless) {
+        printCycleStats(); // After every round; headless runs print once at the end
+    }
+}
+
+void display(void)
+{
+    auto start = std::chrono::steady_clock::now();
+    bool switched = g_NextScene != g_Scene;
+    if (switched) {
+        showScene(g_NextScene);
+    }
+
+    drawFrame();
+
+    if (g_CycleFrames > 0) {
+        glFinish();
+        cycleFrame(switched, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    presentFrame();
+    endOverlayFrame();
+}
+
+void galleryKeyboard(unsigned char key, int x, int y)
+{
+    if (key >= '1' && key < '1' + std::min(GALLERY_SIZE, 9)) {
+        g_NextScene = key - '1';
+    } else if (key == '\t') {
+        g_NextScene = (g_Scene + 1) % GALLERY_SIZE;
+    } else {
+        if (!sceneModuleKeyboard(key)) {
+            keyboardCallback(key, x, y);
+        }
+        return;
+    }
+    glutPostRedisplay();
+}
+
+void nextCycleFrame()
+{
+    glutPostRedisplay();
+}
+
+void init()
+{
+    // The scene shown changes: the timers poll whichever it is
+    if (!g_Headless) {
+        glutTimerFunc(PATH_ASSET_POLL_MS, pollPathAssetFile, 0);
+        glutTimerFunc(SCENE_MODULE_POLL_MS, pollSceneModuleFile, 0);
+    }
+
+    glEnable(GL_LINE_SMOOTH);
+    glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
+}
+
+int main(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--scene") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            g_NextScene = -1;
+            for (int k = 0; k < GALLERY_SIZE; k++) {
+                if (strcmp(GALLERY_SCENES[k].name, name) == 0) {
+                    g_NextScene = k;
+                }
+            }
+            if (g_NextScene < 0) {
+                std::cerr << "ERROR: No scene named '" << name << "'" << std::endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--cycle") == 0 && i + 1 < argc) {
+            g_CycleFrames = std::max(1, atoi(argv[++i]));
+        }
+    }
+
+    HeadlessOptions headless;
+    bool offscreen = parseHeadlessArgs(argc, argv, headless);
+    parseFigureArgs(argc, argv);
+    parseEditorArgs(argc, argv);
+
+    // Nothing opened yet: every scene starts from these
+    g_Gallery.resize(GALLERY_SIZE);
+    for (GalleryState& state : g_Gallery) {
+        state.visited = false;
+        state.imageFailed = false;
+        state.module = g_SceneModule;
+        state.assets = g_PathAssets;
+        state.bezierMode = false;
+        state.placingControlPoint = false;
+        state.editorGrid = g_EditorGrid;
+    }
+
+    if (offscreen) {
+        if (headless.software) {
+            std::cerr << "ERROR: The gallery needs a GL context; use ./build/<scene> --headless --soft" << std::endl;
+            return 1;
+        }
+        int status = runHeadless(headless, init, display, reshape);
+        if (g_CycleFrames > 0) {
+            printCycleStats();
+        }
+        return status;
+    }
+
+    glutInit(&argc, argv);
+    glutInitDisplayMode(GLUT_RGBA | GLUT_DOUBLE | GLUT_DEPTH | GLUT_STENCIL);
+    glutInitWindowSize(600, 600);
+    glutInitWindowPosition(100, 100);
+    glutCreateWindow(GALLERY_SCENES[g_NextScene].name);
+
+    init();
+
+    glutDisplayFunc(display);
+    glutReshapeFunc(reshape);
+    if (g_CycleFrames > 0) {
+        glutIdleFunc(nextCycleFrame);
+    }
+
+    // DEBUG
+    glutMouseFunc(mouseCallback);
+    glutKeyboardFunc(galleryKeyboard);
+    glutSpecialFunc(sceneModuleSpecialKey);
+    glutMotionFunc(mouseMotionCallback);
+    glutPassiveMotionFunc(mouseMotionCallback);
+
+    glutMainLoop();
+    return 0;
+}
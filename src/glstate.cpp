@@ -0,0 +1,137 @@
+#pragma once
+
+#include <GL/glut.h>
+
+// GL STATE CACHE
+// 's' with debug.cpp loaded; counters shown with the frame stats ('f')
+// The drawing helpers set color, line width, point size, blending and the
+// 2D texture through these wrappers, which keep a shadow copy of each value
+// and skip the GL call when it would not change anything. Every wrapper call
+// is counted as issued or skipped. Code that changes these values directly
+// must restore them (glPushAttrib/glPopAttrib) or call resetStateCache().
+bool g_StateCache = true;
+
+typedef struct {
+    bool colorKnown;
+    GLfloat color[4];
+    GLfloat lineWidth; // 0 = unknown
+    GLfloat pointSize; // 0 = unknown
+    int blend; // -1 = unknown
+    GLenum blendSrc, blendDst; // GL_NONE = unknown
+    int texture2D; // -1 = unknown
+    GLint texture; // -1 = unknown
+} GLStateShadow;
+
+typedef struct {
+    unsigned issued;
+    unsigned skipped;
+} GLStateCounters;
+
+GLStateShadow g_StateShadow = { false, { 0, 0, 0, 0 }, 0, 0, -1, GL_NONE, GL_NONE, -1, -1 };
+GLStateCounters g_StateCounters = { 0, 0 };
+
+// Forget every shadow value; the next call of each wrapper is always issued
+void resetStateCache()
+{
+    g_StateShadow = { false, { 0, 0, 0, 0 }, 0, 0, -1, GL_NONE, GL_NONE, -1, -1 };
+}
+
+// Color arrays leave the current color undefined after a draw
+void resetStateColor()
+{
+    g_StateShadow.colorKnown = false;
+}
+
+// True when the call has to reach GL; counts it either way
+bool stateChanged(bool changed)
+{
+    if (changed || !g_StateCache) {
+        g_StateCounters.issued++;
+        return true;
+    }
+    g_StateCounters.skipped++;
+    return false;
+}
+
+void stateColor4f(GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+{
+    GLStateShadow& s = g_StateShadow;
+    if (stateChanged(!s.colorKnown || s.color[0] != r || s.color[1] != g || s.color[2] != b || s.color[3] != a)) {
+        glColor4f(r, g, b, a);
+        s.colorKnown = true;
+        s.color[0] = r;
+        s.color[1] = g;
+        s.color[2] = b;
+        s.color[3] = a;
+    }
+}
+
+void stateColor3f(GLfloat r, GLfloat g, GLfloat b)
+{
+    stateColor4f(r, g, b, 1.0f);
+}
+
+void stateLineWidth(GLfloat width)
+{
+    if (stateChanged(g_StateShadow.lineWidth != width)) {
+        glLineWidth(width);
+        g_StateShadow.lineWidth = width;
+    }
+}
+
+void statePointSize(GLfloat size)
+{
+    if (stateChanged(g_StateShadow.pointSize != size)) {
+        glPointSize(size);
+        g_StateShadow.pointSize = size;
+    }
+}
+
+void stateBlend(bool enabled)
+{
+    if (stateChanged(g_StateShadow.blend != (int)enabled)) {
+        if (enabled) {
+            glEnable(GL_BLEND);
+        } else {
+            glDisable(GL_BLEND);
+        }
+        g_StateShadow.blend = enabled;
+    }
+}
+
+void stateBlendFunc(GLenum src, GLenum dst)
+{
+    if (stateChanged(g_StateShadow.blendSrc != src || g_StateShadow.blendDst != dst)) {
+        glBlendFunc(src, dst);
+        g_StateShadow.blendSrc = src;
+        g_StateShadow.blendDst = dst;
+    }
+}
+
+void stateTexture2D(bool enabled)
+{
+    if (stateChanged(g_StateShadow.texture2D != (int)enabled)) {
+        if (enabled) {
+            glEnable(GL_TEXTURE_2D);
+        } else {
+            glDisable(GL_TEXTURE_2D);
+        }
+        g_StateShadow.texture2D = enabled;
+    }
+}
+
+void stateBindTexture(GLuint texture)
+{
+    if (stateChanged(g_StateShadow.texture != (GLint)texture)) {
+        glBindTexture(GL_TEXTURE_2D, texture);
+        g_StateShadow.texture = (GLint)texture;
+    }
+}
+
+// Counters since the last call, then start over
+GLStateCounters takeStateCounters()
+{
+    GLStateCounters counters = g_StateCounters;
+    g_StateCounters = { 0, 0 };
+    return counters;
+}
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <GL/glut.h>
+#include <cstdint>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#include "glstate.cpp"
+#include "shaders.cpp"
+
+// GPU BEZIER
+// ./build/<scene> --bezier gpu, or 'g' with debug.cpp loaded
+// Quadratic Bezier paths (P0, C1, P1, C2, P2, ...) are uploaded once as their
+// control points, one 3-vertex patch per segment. Tessellation shaders then
+// evaluate each segment with a level chosen from its curvature in pixels, so
+// the CPU never flattens the curve. Borders are the resulting isolines; fills
+// add a geometry shader that turns every line into a triangle with the fan
+// pivot, the same triangulation GL_POLYGON gets. Needs GL 4.0 with the
+// compatibility profile (llvmpipe's 4.5 is enough).
+bool g_GpuBezier = false;
+
+// Maximum distance, in pixels, between the curve and its tessellation
+const float GPU_BEZIER_TOLERANCE = 0.2f;
+
+typedef struct {
+    GLuint vbo;
+    GLsizei count; // Patch vertices (3 per segment)
+    std::vector<float> controls; // Kept to tell apart paths with the same hash
+} GpuBezierMesh;
+
+typedef struct {
+    GLuint program;
+    GLint viewportLocation;
+    GLint toleranceLocation;
+    GLint colorLocation;
+    GLint originLocation;
+} GpuBezierProgram;
+
+GpuBezierProgram g_GpuBezierStroke = {};
+GpuBezierProgram g_GpuBezierFill = {};
+bool g_GpuBezierFailed = false;
+std::unordered_map<uint64_t, std::vector<GpuBezierMesh>> g_GpuBezierMeshes;
+size_t g_GpuBezierMeshCount = 0;
+const size_t GPU_BEZIER_MAX_MESHES = 4096;
+
+const char* GPU_BEZIER_VS = "#version 400 compatibility\n"
+                            "layout(location = 0) in vec2 position;\n"
+                            "void main() { gl_Position = vec4(position, 0.0, 1.0); }\n";
+
+const char* GPU_BEZIER_TCS = "#version 400 compatibility\n"
+                             "layout(vertices = 3) out;\n"
+                             "uniform vec2 viewport;\n"
+                             "uniform float tolerance;\n"
+                             "vec2 screen(vec4 p) {\n"
+                             "    vec4 c = gl_ModelViewProjectionMatrix * p;\n"
+                             "    return c.xy / c.w * 0.5 * viewport;\n"
+                             "}\n"
+                             "void main() {\n"
+                             "    gl_out[gl_InvocationID].gl_Position = gl_in[gl_InvocationID].gl_Position;\n"
+                             "    if (gl_InvocationID == 0) {\n"
+                             // n segments deviate from the curve by |P0 - 2 C + P1| / (4 n^2)
+                             "        vec2 d = screen(gl_in[0].gl_Position) - 2.0 * screen(gl_in[1].gl_Position) + screen(gl_in[2].gl_Position);\n"
+                             "        float n = ceil(sqrt(length(d) / (4.0 * tolerance)));\n"
+                             "        gl_TessLevelOuter[0] = 1.0;\n"
+                             "        gl_TessLevelOuter[1] = clamp(n, 1.0, 64.0);\n"
+                             "    }\n"
+                             "}\n";
+
+const char* GPU_BEZIER_TES = "#version 400 compatibility\n"
+                             "layout(isolines, equal_spacing) in;\n"
+                             "void main() {\n"
+                             "    float t = gl_TessCoord.x, u = 1.0 - t;\n"
+                             "    vec4 p = u * u * gl_in[0].gl_Position + 2.0 * u * t * gl_in[1].gl_Position + t * t * gl_in[2].gl_Position;\n"
+                             "    gl_Position = gl_ModelViewProjectionMatrix * p;\n"
+                             "}\n";
+
+const char* GPU_BEZIER_GS = "#version 400 compatibility\n"
+                            "layout(lines) in;\n"
+                            "layout(triangle_strip, max_vertices = 3) out;\n"
+                            "uniform vec2 origin;\n"
+                            "void main() {\n"
+                            "    gl_Position = gl_ModelViewProjectionMatrix * vec4(origin, 0.0, 1.0);\n"
+                            "    EmitVertex();\n"
+                            "    gl_Position = gl_in[0].gl_Position;\n"
+                            "    EmitVertex();\n"
+                            "    gl_Position = gl_in[1].gl_Position;\n"
+                            "    EmitVertex();\n"
+                            "    EndPrimitive();\n"
+                            "}\n";
+
+const char* GPU_BEZIER_FS = "#version 400 compatibility\n"
+                            "uniform vec3 color;\n"
+                            "void main() { gl_FragColor = vec4(color, 1.0); }\n";
+
+bool buildGpuBezierProgram(GpuBezierProgram& out, bool fill)
+{
+    GLenum types[5] = { GL_VERTEX_SHADER, GL_TESS_CONTROL_SHADER, GL_TESS_EVALUATION_SHADER, GL_FRAGMENT_SHADER, GL_GEOMETRY_SHADER };
+    const char* sources[5] = { GPU_BEZIER_VS, GPU_BEZIER_TCS, GPU_BEZIER_TES, GPU_BEZIER_FS, GPU_BEZIER_GS };
+    out.program = buildShaderStages(types, sources, fill ? 5 : 4);
+    if (!out.program) {
+        return false;
+    }
+    out.viewportLocation = glGetUniformLocation(out.program, "viewport");
+    out.toleranceLocation = glGetUniformLocation(out.program, "tolerance");
+    out.colorLocation = glGetUniformLocation(out.program, "color");
+    out.originLocation = glGetUniformLocation(out.program, "origin");
+    return true;
+}
+
+bool initGpuBezier()
+{
+    if (g_GpuBezierStroke.program) {
+        return true;
+    }
+    if (g_GpuBezierFailed) {
+        return false;
+    }
+    if (!buildGpuBezierProgram(g_GpuBezierStroke, false) || !buildGpuBezierProgram(g_GpuBezierFill, true)) {
+        std::cerr << "ERROR: GPU Bezier tessellation unavailable" << std::endl;
+        if (g_GpuBezierStroke.program) {
+            glDeleteProgram(g_GpuBezierStroke.program);
+            g_GpuBezierStroke.program = 0;
+        }
+        g_GpuBezierFailed = true;
+        return false;
+    }
+    return true;
+}
+
+// False when disabled, unsupported, or another program (e.g. overdraw
+// counting) is in charge of the current draw calls
+bool gpuBezierAvailable()
+{
+    if (!g_GpuBezier) {
+        return false;
+    }
+    GLint current = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &current);
+    return current == 0 && initGpuBezier();
+}
+
+void clearGpuBezierMeshes()
+{
+    for (auto& bucket : g_GpuBezierMeshes) {
+        for (GpuBezierMesh& mesh : bucket.second) {
+            glDeleteBuffers(1, &mesh.vbo);
+        }
+    }
+    g_GpuBezierMeshes.clear();
+    g_GpuBezierMeshCount = 0;
+}
+
+// FNV-1a over the raw bytes, for content-keyed buffer caches
+uint64_t hashFloats(const std::vector<float>& values)
+{
+    uint64_t hash = 14695981039346656037ull;
+    const unsigned char* bytes = (const unsigned char*)values.data();
+    for (size_t i = 0; i < values.size() * sizeof(float); i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// controls: x, y pairs of P0, C1, P1, C2, P2, ... as given to genBezier
+const GpuBezierMesh& gpuBezierMesh(const std::vector<float>& controls)
+{
+    std::vector<GpuBezierMesh>& bucket = g_GpuBezierMeshes[hashFloats(controls)];
+    for (const GpuBezierMesh& mesh : bucket) {
+        if (mesh.controls == controls) {
+            return mesh;
+        }
+    }
+
+    if (g_GpuBezierMeshCount >= GPU_BEZIER_MAX_MESHES) {
+        clearGpuBezierMeshes();
+        return gpuBezierMesh(controls);
+    }
+
+    // Segments share their end points; patches need them repeated
+    std::vector<float> patches;
+    for (size_t i = 0; i + 5 < controls.size(); i += 4) {
+        patches.insert(patches.end(), controls.begin() + i, controls.begin() + i + 6);
+    }
+
+    GpuBezierMesh mesh;
+    mesh.count = (GLsizei)(patches.size() / 2);
+    mesh.controls = controls;
+    glGenBuffers(1, &mesh.vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+    glBufferData(GL_ARRAY_BUFFER, patches.size() * sizeof(float), patches.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    bucket.push_back(mesh);
+    g_GpuBezierMeshCount++;
+    return bucket.back();
+}
+
+// Draw a quadratic Bezier path with the current GL matrices. Fills are fanned
+// from (originX, originY): the first control point for AREA, (0, 0) for AREAFIX.
+void gpuBezierSubmit(bool fill, float width, float r, float g, float b,
+    const std::vector<float>& controls, float originX, float originY)
+{
+    if (controls.size() < 6 || !initGpuBezier()) {
+        return;
+    }
+    const GpuBezierMesh& mesh = gpuBezierMesh(controls);
+    const GpuBezierProgram& program = fill ? g_GpuBezierFill : g_GpuBezierStroke;
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    // llvmpipe drops every tessellated draw after the first one while
+    // GL_LINE_SMOOTH is on, so strokes are drawn without it
+    glPushAttrib(GL_ENABLE_BIT);
+    glDisable(GL_LINE_SMOOTH);
+    glUseProgram(program.program);
+    glUniform2f(program.viewportLocation, (float)viewport[2], (float)viewport[3]);
+    glUniform1f(program.toleranceLocation, GPU_BEZIER_TOLERANCE);
+    glUniform3f(program.colorLocation, r, g, b);
+    if (fill) {
+        glUniform2f(program.originLocation, originX, originY);
+    } else {
+        stateLineWidth(width);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
+    glPatchParameteri(GL_PATCH_VERTICES, 3);
+    glDrawArrays(GL_PATCHES, 0, mesh.count);
+    glDisableVertexAttribArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glUseProgram(0);
+    glPopAttrib();
+}
@@ -0,0 +1,302 @@
+#pragma once
+
+#include "headless.h"
+
+// A scene module (scenemodule.cpp) uses the host's
+#ifndef SCENE_MODULE
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GL/glut.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// HEADLESS MODE
+// ./build/<scene> --headless [WIDTHxHEIGHT] [--frames N] [--out frame.png] [--soft | --core]
+// Creates an EGL surfaceless context (llvmpipe works fine), renders display()
+// into an offscreen framebuffer N times, prints frame-time statistics and
+// writes the last frame as a PNG. No display server is needed. HeadlessOptions
+// only says where and how the frames are made; the flags that change how a
+// scene is drawn are parsed next to their globals (parseFigureArgs() in
+// figure.cpp, parseEditorArgs() in debug.cpp).
+
+bool g_Headless = false;
+bool g_CoreProfile = false; // No fixed-function calls allowed
+bool g_ReportFirstFrame = false; // Print the time from startup to the first presentFrame()
+const std::chrono::steady_clock::time_point g_ProgramStart = std::chrono::steady_clock::now();
+
+typedef struct {
+    int width;
+    int height;
+    int frames;
+    std::string output;
+    bool software; // --soft: CPU rasterizer (softraster.cpp) instead of a GL context
+    bool core; // --core: GL 3.3 core context (also turns on --modern), for scenes drawn through figure.cpp
+} HeadlessOptions;
+
+// Returns true when --headless was given, filling opts from the other flags
+bool parseHeadlessArgs(int argc, char* argv[], HeadlessOptions& opts)
+{
+    opts.width = 600;
+    opts.height = 600;
+    opts.frames = 100;
+    opts.output = "frame.png";
+    opts.software = false;
+    opts.core = false;
+
+    bool headless = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+            if (i + 1 < argc && sscanf(argv[i + 1], "%dx%d", &opts.width, &opts.height) == 2) {
+                i++;
+            }
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            opts.frames = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            opts.output = argv[++i];
+        } else if (strcmp(argv[i], "--soft") == 0) {
+            opts.software = true;
+        } else if (strcmp(argv[i], "--core") == 0) {
+            opts.core = true;
+        }
+    }
+    return headless;
+}
+
+// Use instead of glutSwapBuffers() at the end of display()
+void presentFrame()
+{
+    if (!g_Headless) {
+        glutSwapBuffers();
+    }
+    if (g_ReportFirstFrame) {
+        g_ReportFirstFrame = false;
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - g_ProgramStart).count();
+        std::cout << "First frame: " << ms << " ms after startup" << std::endl;
+    }
+}
+
+// Use instead of glutPostRedisplay() in code that also runs headless
+void requestRedisplay()
+{
+    if (!g_Headless) {
+        glutPostRedisplay();
+    }
+}
+
+// Offscreen context with a color + depth/stencil framebuffer bound as the default target
+bool initHeadlessContext(int width, int height, bool core)
+{
+    EGLDisplay display = EGL_NO_DISPLAY;
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay) {
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    }
+    if (display == EGL_NO_DISPLAY) {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    EGLint major, minor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+        std::cerr << "ERROR: Could not initialize EGL" << std::endl;
+        return false;
+    }
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        std::cerr << "ERROR: EGL has no desktop OpenGL support" << std::endl;
+        return false;
+    }
+
+    // Compatibility profile: the scenes use the fixed-function pipeline
+    EGLint compatibility[] = {
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLint coreProfile[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLContext context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, core ? coreProfile : compatibility);
+    if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        std::cerr << "ERROR: Could not create a surfaceless GL context (0x" << std::hex
+                  << eglGetError() << std::dec << ")" << std::endl;
+        return false;
+    }
+
+    GLuint fbo, color, depth;
+    glGenFramebuffers(1, &fbo);
+    glGenRenderbuffers(1, &color);
+    glGenRenderbuffers(1, &depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "ERROR: Headless framebuffer incomplete" << std::endl;
+        return false;
+    }
+    glViewport(0, 0, width, height);
+
+    std::cout << "Headless: " << glGetString(GL_RENDERER) << ", OpenGL "
+              << glGetString(GL_VERSION) << ", " << width << "x" << height << std::endl;
+    return true;
+}
+
+// --- PNG output (stored deflate blocks, no compression library needed) ---
+
+unsigned int pngCrc(unsigned int crc, const unsigned char* data, size_t length)
+{
+    static unsigned int table[256];
+    if (!table[1]) {
+        for (unsigned int n = 0; n < 256; n++) {
+            unsigned int c = n;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void pngPutU32(std::vector<unsigned char>& out, unsigned int v)
+{
+    out.push_back(v >> 24);
+    out.push_back(v >> 16);
+    out.push_back(v >> 8);
+    out.push_back(v);
+}
+
+void pngChunk(FILE* f, const char* type, const std::vector<unsigned char>& data)
+{
+    std::vector<unsigned char> chunk;
+    pngPutU32(chunk, (unsigned int)data.size());
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    pngPutU32(chunk, pngCrc(0, chunk.data() + 4, chunk.size() - 4));
+    fwrite(chunk.data(), 1, chunk.size(), f);
+}
+
+// rgba is bottom-up, as returned by glReadPixels
+bool writePNG(const char* filename, int width, int height, const unsigned char* rgba)
+{
+    FILE* f = fopen(filename, "wb");
+    if (!f) {
+        std::cerr << "ERROR: Could not open '" << filename << "' for writing" << std::endl;
+        return false;
+    }
+    static const unsigned char signature[8] = { 137, 'P', 'N', 'G', '\r', '\n', 26, '\n' };
+    fwrite(signature, 1, 8, f);
+
+    std::vector<unsigned char> header;
+    pngPutU32(header, width);
+    pngPutU32(header, height);
+    header.push_back(8); // Bit depth
+    header.push_back(6); // RGBA
+    header.push_back(0);
+    header.push_back(0);
+    header.push_back(0);
+    pngChunk(f, "IHDR", header);
+
+    // Scanlines (filter byte 0) flipped to top-down
+    size_t stride = (size_t)width * 4;
+    std::vector<unsigned char> raw;
+    raw.reserve((stride + 1) * height);
+    for (int y = height - 1; y >= 0; y--) {
+        raw.push_back(0);
+        raw.insert(raw.end(), rgba + y * stride, rgba + (y + 1) * stride);
+    }
+
+    std::vector<unsigned char> zlib = { 0x78, 0x01 };
+    unsigned int a = 1, b = 0;
+    for (size_t pos = 0; pos < raw.size();) {
+        size_t length = std::min<size_t>(65535, raw.size() - pos);
+        zlib.push_back(pos + length == raw.size() ? 1 : 0); // BFINAL, stored
+        zlib.push_back(length & 0xFF);
+        zlib.push_back(length >> 8);
+        zlib.push_back(~length & 0xFF);
+        zlib.push_back((~length >> 8) & 0xFF);
+        for (size_t i = pos; i < pos + length; i++) {
+            a = (a + raw[i]) % 65521;
+            b = (b + a) % 65521;
+        }
+        zlib.insert(zlib.end(), raw.begin() + pos, raw.begin() + pos + length);
+        pos += length;
+    }
+    pngPutU32(zlib, (b << 16) | a);
+    pngChunk(f, "IDAT", zlib);
+    pngChunk(f, "IEND", std::vector<unsigned char>());
+
+    fclose(f);
+    return true;
+}
+
+// --- Driver ---
+
+void printFrameStats(std::vector<double> times)
+{
+    double first = times[0];
+    std::sort(times.begin(), times.end());
+    double total = 0;
+    for (double t : times) {
+        total += t;
+    }
+    size_t n = times.size();
+    printf("Frames: %zu  first: %.3f ms  min: %.3f  median: %.3f  mean: %.3f  p95: %.3f  max: %.3f ms\n",
+        n, first, times[0], times[n / 2], total / n, times[std::min(n - 1, (size_t)(n * 0.95))], times[n - 1]);
+}
+
+// init() runs once after the context exists (may be NULL), reshape() may be NULL
+int runHeadless(const HeadlessOptions& opts, void (*init)(), void (*display)(), void (*reshape)(int, int))
+{
+    g_Headless = true;
+    g_CoreProfile = opts.core;
+    if (!initHeadlessContext(opts.width, opts.height, opts.core)) {
+        return EXIT_FAILURE;
+    }
+
+    if (init) {
+        init();
+    }
+    if (reshape) {
+        reshape(opts.width, opts.height);
+    }
+
+    std::vector<double> times(opts.frames);
+    for (int i = 0; i < opts.frames; i++) {
+        auto start = std::chrono::steady_clock::now();
+        display();
+        glFinish();
+        times[i] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    for (GLenum error; (error = glGetError()) != GL_NO_ERROR;) {
+        std::cerr << "GL error 0x" << std::hex << error << std::dec << std::endl;
+    }
+
+    std::vector<unsigned char> pixels((size_t)opts.width * opts.height * 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, opts.width, opts.height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    if (writePNG(opts.output.c_str(), opts.width, opts.height, pixels.data())) {
+        std::cout << "Wrote " << opts.output << std::endl;
+    }
+
+    printFrameStats(times);
+    return EXIT_SUCCESS;
+}
+#endif // SCENE_MODULE
@@ -0,0 +1,7 @@
+#pragma once
+
+// What the scenes use of headless.cpp. A scene module (scenemodule.cpp) only
+// includes this, so it asks the host whether there is a window to redraw.
+
+void presentFrame();
+void requestRedisplay();
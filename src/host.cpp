@@ -0,0 +1,178 @@
+#include <GL/glut.h>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "headless.cpp"
+
+// DEBUG
+#include "debug.cpp"
+
+#include "figure.cpp"
+#include "scenemodule.cpp"
+
+// SCENE HOST
+// ./build/host build/<scene>.so [--image reference.png] [--extent E] [scene flags]
+// The GLUT program of a scene (master.cpp, main.cpp, ...) with its drawShape()
+// taken from a scene module instead (scenemodule.cpp). Leave it running and
+// rebuild the module, e.g. with make live-host: the new drawShape() shows up
+// on the next frame without restarting anything. The path assets are
+// <scene>.paths; the flags are the scenes' own (--headless, --modern, ...).
+// The view extent, background, keys and timer are the module's when it
+// exports them (scenemodule.h); --extent overrides its extent.
+
+float g_ViewExtent = 0.0f; // --extent, 0 for the module's
+std::string g_ReferenceImage;
+
+void drawShape()
+{
+    drawSceneModule();
+}
+
+// Static layer: cached between mouse events (compositor.cpp)
+void drawScene()
+{
+    // DEBUG
+    if (debug) {
+        drawImageReference();
+    }
+
+    beginLayeredFrame();
+    drawShape();
+    endLayeredFrame();
+
+    // DEBUG
+    if (debug) {
+        drawAxes(1.1f, 1.5f);
+    }
+}
+
+void display(void)
+{
+    glClear(GL_COLOR_BUFFER_BIT);
+    stateBlend(true);
+    stateBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    // DEBUG
+    if (g_OverdrawMode) {
+        drawOverdraw(drawShape);
+        presentFrame();
+        endOverlayFrame();
+        return;
+    }
+    drawStaticLayer(drawScene);
+
+    // DEBUG: overlay, redrawn on every mouse event
+    if (debug) {
+        drawCoordinatesText();
+        drawBezierDebug();
+        drawStateCounters();
+    }
+
+    presentFrame();
+    endOverlayFrame();
+}
+
+float viewExtent()
+{
+    return g_ViewExtent > 0.0f ? g_ViewExtent : g_SceneModule.viewExtent;
+}
+
+void reshape(int w, int h)
+{
+    glViewport(0, 0, (GLsizei)w, (GLsizei)h);
+
+    // Keep a 1:1 aspect ratio
+    float aspect = (float)w / (float)h;
+    float extent = viewExtent();
+    if (w >= h) {
+        ortho2D(-extent * aspect, extent * aspect, -extent, extent);
+    } else {
+        ortho2D(-extent, extent, -extent / aspect, extent / aspect);
+    }
+}
+
+void hostKeyboard(unsigned char key, int x, int y)
+{
+    if (!sceneModuleKeyboard(key)) {
+        keyboardCallback(key, x, y);
+    }
+}
+
+void init()
+{
+    // DEBUG
+    if (!g_ReferenceImage.empty()) {
+        loadTexture(g_ReferenceImage.c_str());
+    }
+    watchPathAssets();
+    watchSceneModule();
+    startSceneModuleTimer();
+
+    const float* background = g_SceneModule.background;
+    glClearColor(background[0], background[1], background[2], 1.0f);
+    glEnable(GL_LINE_SMOOTH);
+    glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
+}
+
+int main(int argc, char* argv[])
+{
+    const char* module = NULL;
+    for (int i = 1; i < argc; i++) {
+        size_t length = strlen(argv[i]);
+        if (strcmp(argv[i], "--image") == 0 && i + 1 < argc) {
+            g_ReferenceImage = argv[++i];
+        } else if (strcmp(argv[i], "--extent") == 0 && i + 1 < argc) {
+            g_ViewExtent = (float)atof(argv[++i]);
+        } else if (!module && length > 3 && strcmp(argv[i] + length - 3, ".so") == 0) {
+            module = argv[i];
+        }
+    }
+    if (!module) {
+        std::cerr << "Usage: " << argv[0] << " build/<scene>.so [--image reference.png] [--extent E] [scene flags]" << std::endl;
+        return 1;
+    }
+
+    HeadlessOptions headless;
+    bool offscreen = parseHeadlessArgs(argc, argv, headless);
+    parseFigureArgs(argc, argv);
+    parseEditorArgs(argc, argv);
+
+    std::string scene = module;
+    scene = scene.substr(scene.rfind('/') + 1);
+    openPathAssets((scene.substr(0, scene.size() - 3) + ".paths").c_str());
+    if (!openSceneModule(module)) {
+        return 1;
+    }
+    if (offscreen) {
+        if (headless.software) {
+            return runSoftware(headless, drawShape, viewExtent());
+        }
+        return runHeadless(headless, init, display, reshape);
+    }
+
+    glutInit(&argc, argv);
+    glutInitDisplayMode(GLUT_RGBA | GLUT_DOUBLE | GLUT_DEPTH | GLUT_STENCIL);
+    glutInitWindowSize(600, 600);
+    glutInitWindowPosition(100, 100);
+    glutCreateWindow(scene.c_str());
+
+    init();
+
+    glutDisplayFunc(display);
+    glutReshapeFunc(reshape);
+
+    // DEBUG
+    glutMouseFunc(mouseCallback);
+    glutKeyboardFunc(hostKeyboard);
+    glutSpecialFunc(sceneModuleSpecialKey);
+    glutMotionFunc(mouseMotionCallback);
+    glutPassiveMotionFunc(mouseMotionCallback);
+
+    glutMainLoop();
+    return 0;
+}
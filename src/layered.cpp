@@ -0,0 +1,152 @@
+#pragma once
+
+#include <GL/glut.h>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+// LAYERED MODE State
+// Draw calls are recorded instead of issued, and every call gets a depth from
+// its submission order (later = nearer). Opaque fills are then drawn
+// front-to-back with the depth test on, so hidden fragments are rejected
+// before shading, and blended borders/points follow back-to-front, tested
+// against (but not writing) depth. The final image is the same as drawing in
+// painter's order.
+bool g_LayeredMode = false;
+bool g_FrameStats = false;
+
+typedef struct {
+    GLenum primitive;
+    bool opaque;
+    float width;
+    float r, g, b;
+    GLfloat modelview[16];
+    GLint first; // First vertex in g_LayeredVertices
+    GLsizei count;
+} LayeredDraw;
+
+std::vector<LayeredDraw> g_LayeredDraws;
+std::vector<float> g_LayeredVertices; // x, y pairs for the whole frame
+
+GLuint g_FrameStatsQuery = 0;
+std::chrono::steady_clock::time_point g_FrameStatsStart;
+
+// Record a draw call. withOrigin prepends (0, 0), as AREAFIX does.
+void layeredSubmit(GLenum primitive, bool opaque, float width, float r, float g, float b,
+    const std::vector<float>& X, const std::vector<float>& Y, size_t n, bool withOrigin = false)
+{
+    LayeredDraw d;
+    d.primitive = primitive;
+    d.opaque = opaque;
+    d.width = width;
+    d.r = r;
+    d.g = g;
+    d.b = b;
+    glGetFloatv(GL_MODELVIEW_MATRIX, d.modelview);
+    d.first = (GLint)(g_LayeredVertices.size() / 2);
+
+    if (withOrigin) {
+        g_LayeredVertices.push_back(0.0f);
+        g_LayeredVertices.push_back(0.0f);
+    }
+    for (size_t i = 0; i < n; i++) {
+        g_LayeredVertices.push_back(X[i]);
+        g_LayeredVertices.push_back(Y[i]);
+    }
+    d.count = (GLsizei)(g_LayeredVertices.size() / 2) - d.first;
+    g_LayeredDraws.push_back(d);
+}
+
+void issueLayeredDraw(const LayeredDraw& d, double depth)
+{
+    glLoadMatrixf(d.modelview);
+    glDepthRange(depth, depth);
+    glColor3f(d.r, d.g, d.b);
+    if (d.primitive == GL_POINTS) {
+        glPointSize(d.width);
+    } else if (d.primitive != GL_POLYGON) {
+        glLineWidth(d.width);
+    }
+    glDrawArrays(d.primitive, d.first, d.count);
+}
+
+void flushLayered()
+{
+    size_t n = g_LayeredDraws.size();
+    if (n == 0) {
+        return;
+    }
+
+    glPushAttrib(GL_ENABLE_BIT | GL_DEPTH_BUFFER_BIT | GL_VIEWPORT_BIT | GL_LINE_BIT | GL_POINT_BIT | GL_CURRENT_BIT);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 0, g_LayeredVertices.data());
+
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+
+    // Opaque fills, nearest first
+    glDepthMask(GL_TRUE);
+    for (size_t i = n; i-- > 0;) {
+        if (g_LayeredDraws[i].opaque) {
+            issueLayeredDraw(g_LayeredDraws[i], 1.0 - (double)(i + 1) / (n + 1));
+        }
+    }
+
+    // Blended borders and points, in submission order
+    glDepthMask(GL_FALSE);
+    for (size_t i = 0; i < n; i++) {
+        if (!g_LayeredDraws[i].opaque) {
+            issueLayeredDraw(g_LayeredDraws[i], 1.0 - (double)(i + 1) / (n + 1));
+        }
+    }
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glPopMatrix();
+    glPopAttrib();
+}
+
+// Call around the scene in display()
+void beginLayeredFrame()
+{
+    if (g_FrameStats) {
+        if (!g_FrameStatsQuery) {
+            glGenQueries(1, &g_FrameStatsQuery);
+        }
+        glFinish();
+        g_FrameStatsStart = std::chrono::steady_clock::now();
+        glBeginQuery(GL_SAMPLES_PASSED, g_FrameStatsQuery);
+    }
+    if (g_LayeredMode) {
+        g_LayeredDraws.clear();
+        g_LayeredVertices.clear();
+        glPushAttrib(GL_DEPTH_BUFFER_BIT);
+        glDepthMask(GL_TRUE);
+        glClearDepth(1.0);
+        glClear(GL_DEPTH_BUFFER_BIT);
+        glPopAttrib();
+    }
+}
+
+void endLayeredFrame()
+{
+    size_t draws = g_LayeredDraws.size();
+    if (g_LayeredMode) {
+        flushLayered();
+        g_LayeredDraws.clear();
+    }
+    if (g_FrameStats) {
+        glEndQuery(GL_SAMPLES_PASSED);
+        GLuint64 fragments = 0;
+        glGetQueryObjectui64v(g_FrameStatsQuery, GL_QUERY_RESULT, &fragments);
+        glFinish();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - g_FrameStatsStart).count();
+        std::cout << (g_LayeredMode ? "Layered" : "Painter") << ": fragments=" << fragments
+                  << " time=" << ms << "ms";
+        if (g_LayeredMode) {
+            std::cout << " draws=" << draws;
+        }
+        std::cout << std::endl;
+    }
+}
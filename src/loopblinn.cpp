@@ -0,0 +1,231 @@
+#pragma once
+
+#include <GL/glut.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#include "gpubezier.cpp"
+
+// LOOP-BLINN FILLS
+// ./build/<scene> --bezier exact, or 'x' with debug.cpp loaded
+// Filled quadratic Bezier paths are drawn from their control polygon only:
+// a fan of triangles over the on-curve points plus one triangle (P0, C, P1)
+// per segment whose corners carry the canonical coordinates (0, 0),
+// (1/2, 0), (1, 1). The fragment shader keeps the side u^2 - v < 0, so the
+// curved edge is evaluated exactly per pixel at any zoom. Overlapping
+// triangles are resolved with the stencil buffer (two-sided INCR/DECR, i.e.
+// the non-zero rule), then a bounding quad covers the non-zero pixels and
+// resets the stencil. Needs a stencil buffer; without one, fills fall back
+// to tessellation.
+bool g_LoopBlinn = false;
+
+// --bezier cpu|gpu|exact: g_GpuBezier (gpubezier.cpp) tessellates on the GPU,
+// exact adds these fills on top
+void parseBezierArgs(int argc, char* argv[])
+{
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--bezier") == 0) {
+            const char* mode = argv[++i];
+            g_GpuBezier = strcmp(mode, "gpu") == 0 || strcmp(mode, "exact") == 0;
+            g_LoopBlinn = strcmp(mode, "exact") == 0;
+        }
+    }
+}
+
+typedef struct {
+    GLuint vbo;
+    GLsizei count; // Triangle vertices: x, y, u, v
+    float minX, minY, maxX, maxY; // Cover quad
+    std::vector<float> key; // Control points + pivot
+} LoopBlinnMesh;
+
+GLuint g_LoopBlinnProgram = 0;
+bool g_LoopBlinnFailed = false;
+std::unordered_map<uint64_t, std::vector<LoopBlinnMesh>> g_LoopBlinnMeshes;
+size_t g_LoopBlinnMeshCount = 0;
+const size_t LOOP_BLINN_MAX_MESHES = 4096;
+
+const char* LOOP_BLINN_VS = "#version 120\n"
+                            "attribute vec2 position;\n"
+                            "attribute vec2 uv;\n"
+                            "varying vec2 curve;\n"
+                            "void main() {\n"
+                            "    curve = uv;\n"
+                            "    gl_Position = gl_ModelViewProjectionMatrix * vec4(position, 0.0, 1.0);\n"
+                            "}\n";
+
+const char* LOOP_BLINN_FS = "#version 120\n"
+                            "varying vec2 curve;\n"
+                            "void main() {\n"
+                            "    if (curve.x * curve.x - curve.y > 0.0) discard;\n"
+                            "    gl_FragColor = vec4(0.0);\n" // Color writes are masked
+                            "}\n";
+
+bool initLoopBlinn()
+{
+    if (g_LoopBlinnProgram) {
+        return true;
+    }
+    if (g_LoopBlinnFailed) {
+        return false;
+    }
+    GLint stencilBits = 0;
+    glGetIntegerv(GL_STENCIL_BITS, &stencilBits);
+    if (stencilBits == 0) {
+        std::cerr << "ERROR: Loop-Blinn fills need a stencil buffer" << std::endl;
+        g_LoopBlinnFailed = true;
+        return false;
+    }
+
+    GLuint vs = compileShader(GL_VERTEX_SHADER, LOOP_BLINN_VS);
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, LOOP_BLINN_FS);
+    GLuint program = vs && fs ? glCreateProgram() : 0;
+    if (program) {
+        glAttachShader(program, vs);
+        glAttachShader(program, fs);
+        glBindAttribLocation(program, 0, "position");
+        glBindAttribLocation(program, 1, "uv");
+        glLinkProgram(program);
+        GLint ok = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &ok);
+        if (!ok) {
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+    if (vs)
+        glDeleteShader(vs);
+    if (fs)
+        glDeleteShader(fs);
+    if (!program) {
+        std::cerr << "ERROR: Loop-Blinn fills unavailable" << std::endl;
+        g_LoopBlinnFailed = true;
+        return false;
+    }
+    g_LoopBlinnProgram = program;
+
+    // Every fill leaves the stencil at zero; start from there
+    glClearStencil(0);
+    glClear(GL_STENCIL_BUFFER_BIT);
+    return true;
+}
+
+// False when disabled, unsupported, or another program (e.g. overdraw
+// counting) is in charge of the current draw calls
+bool loopBlinnAvailable()
+{
+    if (!g_LoopBlinn) {
+        return false;
+    }
+    GLint current = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &current);
+    return current == 0 && initLoopBlinn();
+}
+
+void clearLoopBlinnMeshes()
+{
+    for (auto& bucket : g_LoopBlinnMeshes) {
+        for (LoopBlinnMesh& mesh : bucket.second) {
+            glDeleteBuffers(1, &mesh.vbo);
+        }
+    }
+    g_LoopBlinnMeshes.clear();
+    g_LoopBlinnMeshCount = 0;
+}
+
+// controls: x, y pairs of P0, C1, P1, C2, P2, ... as given to genBezier
+const LoopBlinnMesh& loopBlinnMesh(const std::vector<float>& controls, float pivotX, float pivotY)
+{
+    std::vector<float> key = controls;
+    key.push_back(pivotX);
+    key.push_back(pivotY);
+
+    std::vector<LoopBlinnMesh>& bucket = g_LoopBlinnMeshes[hashFloats(key)];
+    for (const LoopBlinnMesh& mesh : bucket) {
+        if (mesh.key == key) {
+            return mesh;
+        }
+    }
+
+    if (g_LoopBlinnMeshCount >= LOOP_BLINN_MAX_MESHES) {
+        clearLoopBlinnMeshes();
+        return loopBlinnMesh(controls, pivotX, pivotY);
+    }
+
+    std::vector<float> vertices;
+    for (size_t i = 0; i + 5 < controls.size(); i += 4) {
+        const float* p = &controls[i]; // P0, C, P1
+        float fan[12] = { pivotX, pivotY, 0, 1, p[0], p[1], 0, 1, p[4], p[5], 0, 1 };
+        float curve[12] = { p[0], p[1], 0, 0, p[2], p[3], 0.5f, 0, p[4], p[5], 1, 1 };
+        vertices.insert(vertices.end(), fan, fan + 12);
+        vertices.insert(vertices.end(), curve, curve + 12);
+    }
+
+    LoopBlinnMesh mesh;
+    mesh.count = (GLsizei)(vertices.size() / 4);
+    mesh.key = key;
+    mesh.minX = mesh.maxX = pivotX;
+    mesh.minY = mesh.maxY = pivotY;
+    for (size_t i = 0; i + 1 < controls.size(); i += 2) {
+        mesh.minX = std::min(mesh.minX, controls[i]);
+        mesh.maxX = std::max(mesh.maxX, controls[i]);
+        mesh.minY = std::min(mesh.minY, controls[i + 1]);
+        mesh.maxY = std::max(mesh.maxY, controls[i + 1]);
+    }
+    glGenBuffers(1, &mesh.vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    bucket.push_back(mesh);
+    g_LoopBlinnMeshCount++;
+    return bucket.back();
+}
+
+// Fill a quadratic Bezier path with the current GL matrices, fanned from
+// (pivotX, pivotY): the first control point for AREA, (0, 0) for AREAFIX
+void loopBlinnFill(float r, float g, float b, const std::vector<float>& controls, float pivotX, float pivotY)
+{
+    if (controls.size() < 6 || !initLoopBlinn()) {
+        return;
+    }
+    const LoopBlinnMesh& mesh = loopBlinnMesh(controls, pivotX, pivotY);
+
+    glPushAttrib(GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT | GL_ENABLE_BIT);
+    glEnable(GL_STENCIL_TEST);
+
+    // 1. Winding number into the stencil, no color
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glStencilFunc(GL_ALWAYS, 0, 0xFF);
+    glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_KEEP, GL_INCR_WRAP);
+    glStencilOpSeparate(GL_BACK, GL_KEEP, GL_KEEP, GL_DECR_WRAP);
+    glUseProgram(g_LoopBlinnProgram);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+    glDrawArrays(GL_TRIANGLES, 0, mesh.count);
+    glDisableVertexAttribArray(1);
+    glDisableVertexAttribArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glUseProgram(0);
+
+    // 2. Cover the non-zero pixels and reset the stencil under the quad
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glStencilFunc(GL_NOTEQUAL, 0, 0xFF);
+    glStencilOp(GL_ZERO, GL_ZERO, GL_ZERO);
+    stateColor3f(r, g, b);
+    glBegin(GL_QUADS);
+    glVertex2f(mesh.minX, mesh.minY);
+    glVertex2f(mesh.maxX, mesh.minY);
+    glVertex2f(mesh.maxX, mesh.maxY);
+    glVertex2f(mesh.minX, mesh.maxY);
+    glEnd();
+
+    glPopAttrib();
+}
@@ -11,281 +11,15 @@
 #define M_PI 3.14159265
 #endif
 
+// Con -DSCENE_MODULE solo queda drawShape(), para ./build/host (scenemodule.cpp)
+#ifndef SCENE_MODULE
+#include "headless.cpp"
+
 // DEBUG
 #include "debug.cpp"
+#endif
 
-// --- Estructuras ---
-
-typedef struct {
-    std::vector<float> X;
-    std::vector<float> Y;
-    size_t size;
-} Figure;
-
-typedef struct {
-    float r, g, b;
-} ColorRGB;
-
-typedef enum {
-    AREA,
-    AREAFIX,
-    BORDER,
-    POINTS
-} DrawMode;
-
-typedef struct {
-    float x;
-    float y;
-} Point;
-
-// --- Constantes ---
-
-int SEGMENTS = 100;
-ColorRGB WHITE = { 1.0f, 1.0f, 1.0f };
-ColorRGB BLACK = { 0.0f, 0.0f, 0.0f };
-ColorRGB RED = { 1.0f, 0.0f, 0.0f };
-ColorRGB GREEN = { 0.0f, 1.0f, 0.0f };
-ColorRGB BLUE = { 0.0f, 0.0f, 1.0f };
-ColorRGB ORANGE = { 0.8f, 0.5f, 0.2f };
-ColorRGB YELLOW = { 1.0f, 1.0f, 0.0f };
-
-// --- Funciones auxiliares ---
-
-Figure newFigure(std::vector<float>& X, std::vector<float>& Y)
-{
-    if (X.size() != Y.size()) {
-        throw std::invalid_argument("the sizes do not match");
-    }
-    return { X, Y, X.size() };
-}
-
-Figure pointsToFigure(std::vector<Point> points)
-{
-    std::vector<float> X(points.size());
-    std::vector<float> Y(points.size());
-    for (size_t i = 0; i < points.size(); i++) {
-        X[i] = points[i].x;
-        Y[i] = points[i].y;
-    }
-    return newFigure(X, Y);
-}
-
-// --- Funciones de dibujado ---
-
-void draw(DrawMode mode, Figure fig, float w = 3, ColorRGB c = BLACK)
-{
-    glColor3f(c.r, c.g, c.b);
-
-    switch (mode) {
-    case AREA:
-        glBegin(GL_POLYGON);
-        break;
-    case AREAFIX:
-        glBegin(GL_POLYGON);
-        glVertex2f(0, 0);
-        break;
-    case BORDER:
-        glLineWidth(w);
-        glBegin(GL_LINE_STRIP);
-        break;
-    case POINTS:
-        glPointSize(w);
-        glBegin(GL_POINTS);
-        break;
-    }
-
-    for (size_t i = 0; i < fig.size; i++) {
-        glVertex2f(fig.X[i], fig.Y[i]);
-    }
-    glEnd();
-    glLineWidth(1.0f);
-    glPointSize(1.0f);
-}
-
-void drawWithTrans(DrawMode mode, Figure fig, float cx, float cy, float w = 3,
-    ColorRGB c = BLACK)
-{
-    glPushMatrix();
-    glTranslatef(cx, cy, 0.0f);
-    draw(mode, fig, w, c);
-    glPopMatrix();
-}
-
-void drawWithRotate(DrawMode mode, Figure fig, float angle, float w = 3, ColorRGB c = BLACK)
-{
-    glPushMatrix();
-    glRotatef(angle, 0.0f, 0.0f, 1.0f);
-    draw(mode, fig, w, c);
-    glPopMatrix();
-}
-
-void drawWithScale(DrawMode mode, Figure fig, float scaleX, float scaleY, float w = 3, ColorRGB c = BLACK)
-{
-    glPushMatrix();
-    glScalef(scaleX, scaleY, 1.0f);
-    draw(mode, fig, w, c);
-    glPopMatrix();
-}
-
-void drawWithTransScale(DrawMode mode, Figure fig, float cx, float cy, float scaleX, float scaleY, float w = 3, ColorRGB c = BLACK)
-{
-    glPushMatrix();
-    glTranslatef(cx, cy, 0.0f);
-    glScalef(scaleX, scaleY, 1.0f);
-    draw(mode, fig, w, c);
-    glPopMatrix();
-}
-
-void drawFlower(DrawMode mode, Figure fig, int n, float r, float scaleX, float scaleY, bool skip = false, float w = 3, ColorRGB c = BLACK)
-{
-    float t1 = 0.0;
-    if (skip)
-        t1 = M_PI / n;
-    for (int i = 0; i < n; i++) {
-        glPushMatrix();
-        float theta = 2 * M_PI * i / n + t1;
-        glTranslatef(r * cosf(theta), r * sinf(theta), 0.0f);
-        glRotatef(theta * 180.0f / M_PI, 0, 0, 1);
-        glScalef(scaleX, scaleY, 1.0f);
-        draw(mode, fig, w, c);
-        glPopMatrix();
-    }
-}
-
-// --- Figuras comunes ---
-
-Point getBezierPoint(Point p0, Point p1, Point p2, float t)
-{
-    Point p;
-    float u = 1.0f - t;
-    float tt = t * t;
-    float uu = u * u;
-    float u2t = 2.0f * u * t;
-
-    p.x = uu * p0.x + u2t * p1.x + tt * p2.x;
-    p.y = uu * p0.y + u2t * p1.y + tt * p2.y;
-
-    return p;
-}
-
-Figure genBezier(const std::vector<Point> points)
-{
-    if (points.size() < 3 || points.size() % 2 == 0) {
-        return Figure {};
-    }
-    int n = SEGMENTS;
-    int k = (points.size() - 1) / 2;
-    std::vector<float> X(k * n + 1);
-    std::vector<float> Y(k * n + 1);
-    X[0] = points[0].x;
-    Y[0] = points[0].y;
-    for (size_t i = 0; i < points.size() - 1; i += 2) {
-        Point p0 = points[i];
-        Point p1 = points[i + 1];
-        Point p2 = points[i + 2];
-
-        for (int j = 1; j <= n; ++j) {
-            float t = (float)j / n;
-            Point p = getBezierPoint(p0, p1, p2, t);
-            int l = n * (i / 2) + j;
-            X[l] = p.x;
-            Y[l] = p.y;
-        }
-    }
-    return newFigure(X, Y);
-}
-
-Figure genPoly(int n, bool skip = false)
-{
-    float t1 = 0.0;
-    if (skip)
-        t1 = -M_PI / 2 - M_PI / n;
-    std::vector<float> X(n + 1);
-    std::vector<float> Y(n + 1);
-    for (int i = 0; i < n + 1; i++) {
-        float t = 2 * M_PI * i / n;
-        X[i] = cosf(t + t1);
-        Y[i] = sinf(t + t1);
-    }
-    return newFigure(X, Y);
-}
-
-Figure genCircle(float t1 = 0, float t2 = 2 * M_PI)
-{
-    int n = SEGMENTS;
-    std::vector<float> X(n);
-    std::vector<float> Y(n);
-    for (int i = 0; i < n; i++) {
-        float t = t1 + (t2 - t1) * i / (n - 1);
-        X[i] = cosf(t);
-        Y[i] = sinf(t);
-    }
-    return newFigure(X, Y);
-}
-
-Figure genHoja()
-{
-    int n = SEGMENTS;
-    std::vector<float> X(2 * n);
-    std::vector<float> Y(2 * n);
-    for (int i = 0; i < n; i++) {
-        float t = -1.0 + 2.0 * i / (n - 1);
-        X[i] = t;
-        Y[i] = sinf(M_PI * (t + 1) / 2);
-    }
-    for (int i = 0; i < n; i++) {
-        float t = -1.0 + 2.0 * i / (n - 1);
-        X[n + i] = -t;
-        Y[n + i] = -sinf(M_PI * (t + 1) / 2);
-    }
-    return newFigure(X, Y);
-}
-
-Figure genCardoid(float t1 = 0, float t2 = 2 * M_PI)
-{
-    int n = SEGMENTS;
-    float a = 0.5;
-    std::vector<float> X(n);
-    std::vector<float> Y(n);
-    for (int i = 0; i < n; i++) {
-        float t = t1 + (t2 - t1) * i / (n - 1);
-        X[i] = (a - a * sinf(t)) * cosf(t);
-        Y[i] = (a - a * sinf(t)) * sinf(t);
-    }
-    return newFigure(X, Y);
-}
-
-Figure genRose(int k, bool skip = false, float t1 = 0, float t2 = 2 * M_PI)
-{
-    int n = SEGMENTS;
-    std::vector<float> X(n);
-    std::vector<float> Y(n);
-    for (int i = 0; i < n; i++) {
-        float t = t1 + (t2 - t1) * i / (n - 1);
-        if (skip) {
-            X[i] = sinf(k * t) * cosf(t);
-            Y[i] = sinf(k * t) * sinf(t);
-        } else {
-            X[i] = cosf(k * t) * cosf(t);
-            Y[i] = cosf(k * t) * sinf(t);
-        }
-    }
-    return newFigure(X, Y);
-}
-
-Figure genLemniscate(float t1 = 0, float t2 = 2 * M_PI)
-{
-    int n = SEGMENTS;
-    float a = 1.0;
-    std::vector<float> X(n);
-    std::vector<float> Y(n);
-    for (int i = 0; i < n; i++) {
-        float t = t1 + (t2 - t1) * i / (n - 1);
-        X[i] = a * cosf(t) / (1 + pow(sinf(t), 2));
-        Y[i] = a * sinf(t) * cosf(t) / (1 + pow(sinf(t), 2));
-    }
-    return newFigure(X, Y);
-}
+#include "figure.cpp"
 
 // --- El programa ---
 float r0 = 0.979;
@@ -345,101 +79,127 @@ std::vector<Point> c4 = {
     { -0.249f, -0.7285f }
 };
 
-Figure circle = genCircle();
-Figure batman = genBezier(batmanPoints);
-Figure co1 = genBezier(c1);
-Figure co2 = genBezier(c2);
-Figure co3 = genBezier(c3);
-Figure co4 = genBezier(c4);
-
+// Los caminos de master.paths reemplazan a estos si existen (pathasset.cpp):
+// ./build/master --edit-path batman los abre en el editor de Bezier
 void drawBatman()
 {
-    draw(AREA, batman, 1, BLACK);
-    draw(AREA, co1, 1, YELLOW);
-    draw(AREA, co2, 1, YELLOW);
-    draw(AREA, co3, 1, YELLOW);
-    draw(AREA, co4, 1, YELLOW);
+    draw(AREA, pathFigure("batman", batmanPoints), 1, BLACK);
+    draw(AREA, pathFigure("c1", c1), 1, YELLOW);
+    draw(AREA, pathFigure("c2", c2), 1, YELLOW);
+    draw(AREA, pathFigure("c3", c3), 1, YELLOW);
+    draw(AREA, pathFigure("c4", c4), 1, YELLOW);
 }
 
 void drawShape()
 {
-    glPushMatrix();
-    glScalef(1, 0.56, 1.0f);
-    drawWithScale(AREA, circle, r0, r0, 1, YELLOW);
-    drawWithScale(BORDER, circle, r0, r0, 9);
+    pushMatrix();
+    scale2D(1, 0.56);
+    drawEllipse(AREA, 0, 0, r0, r0, 1, YELLOW);
+    drawEllipse(BORDER, 0, 0, r0, r0, 9);
     drawBatman();
-    glPushMatrix();
-    glScalef(-1, 1, 1.0f);
+    pushMatrix();
+    scale2D(-1, 1);
     drawBatman();
-    glPopMatrix();
-    glPopMatrix();
+    popMatrix();
+    popMatrix();
 }
 
+#ifndef SCENE_MODULE
 // --- Funciones de GLUT ---
 
-void display(void)
+// Capa estatica: se guarda en cache entre eventos del raton (compositor.cpp)
+void drawScene()
 {
-    glClear(GL_COLOR_BUFFER_BIT);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
     // DEBUG
     if (debug) {
         drawImageReference();
     }
 
     // Dibujado principal
+    beginLayeredFrame();
     drawShape();
+    endLayeredFrame();
 
     // DEBUG
     if (debug) {
         drawAxes(1.1f, 1.5f);
+    }
+}
+
+void display(void)
+{
+    glClear(GL_COLOR_BUFFER_BIT);
+    stateBlend(true);
+    stateBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    // DEBUG
+    if (g_OverdrawMode) {
+        drawOverdraw(drawShape);
+        presentFrame();
+        endOverlayFrame();
+        return;
+    }
+    drawStaticLayer(drawScene);
+
+    // DEBUG: overlay, redibujado en cada evento del raton
+    if (debug) {
         drawCoordinatesText();
         drawBezierDebug();
+        drawStateCounters();
     }
 
-    glDisable(GL_BLEND);
-
-    glutSwapBuffers();
+    presentFrame();
+    endOverlayFrame();
 }
 
 void reshape(int w, int h)
 {
     glViewport(0, 0, (GLsizei)w, (GLsizei)h);
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
 
     // Mantener relacion 1/1
     float aspect = (float)w / (float)h;
     float viewExtent = 1.2f;
     if (w >= h) {
-        gluOrtho2D(-viewExtent * aspect, viewExtent * aspect, -viewExtent,
+        ortho2D(-viewExtent * aspect, viewExtent * aspect, -viewExtent,
             viewExtent);
     } else {
-        gluOrtho2D(-viewExtent, viewExtent, -viewExtent / aspect,
+        ortho2D(-viewExtent, viewExtent, -viewExtent / aspect,
             viewExtent / aspect);
     }
+}
+
+void init()
+{
+    // DEBUG
+    loadTexture("batman.png");
+    watchPathAssets();
 
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
+    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+    glEnable(GL_LINE_SMOOTH);
+    glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
 }
 
 int main(int argc, char* argv[])
 {
+    HeadlessOptions headless;
+    bool offscreen = parseHeadlessArgs(argc, argv, headless);
+    parseFigureArgs(argc, argv);
+    parseEditorArgs(argc, argv);
+    openPathAssets("master.paths");
+    if (offscreen) {
+        if (headless.software) {
+            return runSoftware(headless, drawShape, 1.2f);
+        }
+        return runHeadless(headless, init, display, reshape);
+    }
+
     glutInit(&argc, argv);
-    glutInitDisplayMode(GLUT_RGBA | GLUT_DOUBLE | GLUT_DEPTH);
+    glutInitDisplayMode(GLUT_RGBA | GLUT_DOUBLE | GLUT_DEPTH | GLUT_STENCIL);
     glutInitWindowSize(600, 600);
     glutInitWindowPosition(100, 100);
     glutCreateWindow("Main");
 
-    // Init
-
-    // DEBUG
-    loadTexture("batman.png");
-
-    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
-    glEnable(GL_LINE_SMOOTH);
-    glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
+    init();
 
     // Register GLUT callbacks
     glutDisplayFunc(display);
@@ -454,3 +214,4 @@ int main(int argc, char* argv[])
     glutMainLoop();
     return 0;
 }
+#endif // SCENE_MODULE
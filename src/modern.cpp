@@ -0,0 +1,205 @@
+#pragma once
+
+#include <GL/glut.h>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#include "glstate.cpp"
+#include "shaders.cpp"
+#include "softraster.cpp"
+
+// MODERN MODE
+// ./build/<scene> --modern, or 'm' with debug.cpp loaded
+// draw() goes through one GLSL 330 core program: every distinct figure is
+// uploaded once to its own VAO/VBO, and the current 2D transform (the CPU
+// matrix stack from softraster.cpp, times the ortho2D() projection) and the
+// color are uniforms. Runs on a compatibility context next to the legacy
+// path, or alone on a 3.3 core context (--headless --core).
+bool g_ModernMode = false;
+
+// --modern, or --core, which has no fixed-function path to fall back on
+void parseModernArgs(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--modern") == 0 || strcmp(argv[i], "--core") == 0) {
+            g_ModernMode = true;
+        }
+    }
+}
+
+typedef struct {
+    GLuint vao;
+    GLuint vbo;
+    GLsizei count;
+    std::vector<float> vertices; // Kept to tell apart figures with the same hash
+} ModernMesh;
+
+GLuint g_ModernProgram = 0;
+GLint g_ModernTransformLocation = -1;
+GLint g_ModernColorLocation = -1;
+SoftMatrix g_ModernProjection = { 1, 0, 0, 1, 0, 0 }; // World -> clip space
+std::unordered_map<uint64_t, std::vector<ModernMesh>> g_ModernMeshes;
+size_t g_ModernMeshCount = 0;
+const size_t MODERN_MAX_MESHES = 4096;
+
+const char* MODERN_VS = "#version 330 core\n"
+                        "layout(location = 0) in vec2 position;\n"
+                        "uniform mat3 transform;\n"
+                        "void main() {\n"
+                        "    gl_Position = vec4((transform * vec3(position, 1.0)).xy, 0.0, 1.0);\n"
+                        "}\n";
+
+const char* MODERN_FS = "#version 330 core\n"
+                        "uniform vec3 color;\n"
+                        "out vec4 fragColor;\n"
+                        "void main() { fragColor = vec4(color, 1.0); }\n";
+
+bool initModern()
+{
+    if (g_ModernProgram) {
+        return true;
+    }
+    g_ModernProgram = buildShaderProgram(MODERN_VS, MODERN_FS);
+    if (!g_ModernProgram) {
+        std::cerr << "ERROR: Modern renderer unavailable" << std::endl;
+        return false;
+    }
+    g_ModernTransformLocation = glGetUniformLocation(g_ModernProgram, "transform");
+    g_ModernColorLocation = glGetUniformLocation(g_ModernProgram, "color");
+    return true;
+}
+
+// Same mapping as gluOrtho2D
+void modernOrtho2D(float left, float right, float bottom, float top)
+{
+    float sx = 2.0f / (right - left);
+    float sy = 2.0f / (top - bottom);
+    g_ModernProjection = { sx, 0, 0, sy, -(right + left) / (right - left), -(top + bottom) / (top - bottom) };
+}
+
+void clearModernMeshes()
+{
+    for (auto& bucket : g_ModernMeshes) {
+        for (ModernMesh& mesh : bucket.second) {
+            glDeleteBuffers(1, &mesh.vbo);
+            glDeleteVertexArrays(1, &mesh.vao);
+        }
+    }
+    g_ModernMeshes.clear();
+    g_ModernMeshCount = 0;
+}
+
+// Figures are often rebuilt every frame (genBezier(...) inside drawShape), so
+// meshes are looked up by content rather than by address
+const ModernMesh& modernMesh(const std::vector<float>& vertices)
+{
+    uint64_t hash = 14695981039346656037ull; // FNV-1a
+    const unsigned char* bytes = (const unsigned char*)vertices.data();
+    for (size_t i = 0; i < vertices.size() * sizeof(float); i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+
+    std::vector<ModernMesh>& bucket = g_ModernMeshes[hash];
+    for (const ModernMesh& mesh : bucket) {
+        if (mesh.vertices == vertices) {
+            return mesh;
+        }
+    }
+
+    if (g_ModernMeshCount >= MODERN_MAX_MESHES) {
+        clearModernMeshes();
+        return modernMesh(vertices);
+    }
+
+    ModernMesh mesh;
+    mesh.count = (GLsizei)(vertices.size() / 2);
+    mesh.vertices = vertices;
+    glGenVertexArrays(1, &mesh.vao);
+    glGenBuffers(1, &mesh.vbo);
+    glBindVertexArray(mesh.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    bucket.push_back(mesh);
+    g_ModernMeshCount++;
+    return bucket.back();
+}
+
+// Fixed-function draw with the CPU transform, for when another program (the
+// overdraw count pass) is bound: glUseProgram(g_ModernProgram) would replace it
+void modernFallback(GLenum primitive, float width, float r, float g, float b,
+    const std::vector<float>& X, const std::vector<float>& Y, size_t n, bool withOrigin)
+{
+    const SoftMatrix& m = g_SoftStack.back();
+    GLfloat modelview[16] = { m.a, m.b, 0, 0, m.c, m.d, 0, 0, 0, 0, 1, 0, m.e, m.f, 0, 1 };
+    glPushMatrix();
+    glMultMatrixf(modelview);
+    stateColor3f(r, g, b);
+    if (primitive == GL_POINTS) {
+        statePointSize(width);
+    } else if (primitive != GL_TRIANGLE_FAN) {
+        stateLineWidth(width);
+    }
+    glBegin(primitive == GL_TRIANGLE_FAN ? GL_POLYGON : primitive);
+    if (withOrigin) {
+        glVertex2f(0.0f, 0.0f);
+    }
+    for (size_t i = 0; i < n; i++) {
+        glVertex2f(X[i], Y[i]);
+    }
+    glEnd();
+    glPopMatrix();
+}
+
+// Draw with the current CPU transform. withOrigin prepends (0, 0), as AREAFIX does.
+void modernSubmit(GLenum primitive, float width, float r, float g, float b,
+    const std::vector<float>& X, const std::vector<float>& Y, size_t n, bool withOrigin = false)
+{
+    GLint current = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &current);
+    if (current != 0) {
+        modernFallback(primitive, width, r, g, b, X, Y, n, withOrigin);
+        return;
+    }
+    if (!initModern()) {
+        return;
+    }
+
+    static std::vector<float> vertices;
+    vertices.clear();
+    if (withOrigin) {
+        vertices.push_back(0.0f);
+        vertices.push_back(0.0f);
+    }
+    for (size_t i = 0; i < n; i++) {
+        vertices.push_back(X[i]);
+        vertices.push_back(Y[i]);
+    }
+    if (vertices.empty()) {
+        return;
+    }
+    const ModernMesh& mesh = modernMesh(vertices);
+
+    SoftMatrix m = softMultiply(g_ModernProjection, g_SoftStack.back());
+    GLfloat transform[9] = { m.a, m.b, 0, m.c, m.d, 0, m.e, m.f, 1 };
+
+    glUseProgram(g_ModernProgram);
+    glUniformMatrix3fv(g_ModernTransformLocation, 1, GL_FALSE, transform);
+    glUniform3f(g_ModernColorLocation, r, g, b);
+    if (primitive == GL_POINTS) {
+        statePointSize(width);
+    } else if (primitive != GL_TRIANGLE_FAN) {
+        stateLineWidth(width);
+    }
+    glBindVertexArray(mesh.vao);
+    glDrawArrays(primitive, 0, mesh.count);
+    glBindVertexArray(0);
+    glUseProgram(0);
+}
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <GL/glut.h>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "glstate.cpp"
+#include "layered.cpp"
+#include "shaders.cpp"
+
+// OVERDRAW MODE State
+// The scene is rendered into an offscreen R32F target with additive blending,
+// every fragment adding 1.0, so each texel ends up holding the number of
+// layers drawn over that pixel.
+bool g_OverdrawMode = false;
+GLuint g_OverdrawFBO = 0;
+GLuint g_OverdrawTexture = 0;
+GLuint g_OverdrawDepth = 0; // Lets layered mode show its early-z savings
+GLuint g_OverdrawCountProgram = 0;
+GLuint g_OverdrawHeatmapProgram = 0;
+int g_OverdrawWidth = 0;
+int g_OverdrawHeight = 0;
+std::vector<float> g_OverdrawPixels;
+
+const char* OVERDRAW_COUNT_FS = "#version 120\n"
+                                "void main() { gl_FragColor = vec4(1.0); }\n";
+
+const char* OVERDRAW_HEATMAP_VS = "#version 120\n"
+                                  "varying vec2 uv;\n"
+                                  "void main() {\n"
+                                  "    uv = gl_Vertex.xy * 0.5 + 0.5;\n"
+                                  "    gl_Position = vec4(gl_Vertex.xy, 0.0, 1.0);\n"
+                                  "}\n";
+
+// Black (0 layers) -> blue -> cyan -> green -> yellow -> red -> white (max)
+const char* OVERDRAW_HEATMAP_FS = "#version 120\n"
+                                  "uniform sampler2D layers;\n"
+                                  "uniform float maxLayers;\n"
+                                  "varying vec2 uv;\n"
+                                  "void main() {\n"
+                                  "    float n = texture2D(layers, uv).r;\n"
+                                  "    if (n < 0.5) { gl_FragColor = vec4(0.0, 0.0, 0.0, 1.0); return; }\n"
+                                  "    float t = clamp(n / max(maxLayers, 1.0), 0.0, 1.0) * 5.0;\n"
+                                  "    vec3 ramp[6];\n"
+                                  "    ramp[0] = vec3(0.0, 0.0, 1.0);\n"
+                                  "    ramp[1] = vec3(0.0, 1.0, 1.0);\n"
+                                  "    ramp[2] = vec3(0.0, 1.0, 0.0);\n"
+                                  "    ramp[3] = vec3(1.0, 1.0, 0.0);\n"
+                                  "    ramp[4] = vec3(1.0, 0.0, 0.0);\n"
+                                  "    ramp[5] = vec3(1.0, 1.0, 1.0);\n"
+                                  "    int i = int(min(floor(t), 4.0));\n"
+                                  "    gl_FragColor = vec4(mix(ramp[i], ramp[i + 1], t - float(i)), 1.0);\n"
+                                  "}\n";
+
+bool initOverdraw()
+{
+    if (g_OverdrawCountProgram) {
+        return true;
+    }
+    g_OverdrawCountProgram = buildShaderProgram(NULL, OVERDRAW_COUNT_FS);
+    g_OverdrawHeatmapProgram = buildShaderProgram(OVERDRAW_HEATMAP_VS, OVERDRAW_HEATMAP_FS);
+    if (!g_OverdrawCountProgram || !g_OverdrawHeatmapProgram) {
+        std::cerr << "ERROR: Overdraw mode unavailable" << std::endl;
+        return false;
+    }
+    glGenFramebuffers(1, &g_OverdrawFBO);
+    glGenTextures(1, &g_OverdrawTexture);
+    glGenRenderbuffers(1, &g_OverdrawDepth);
+    return true;
+}
+
+// (Re)allocate the layer-count target to match the current viewport
+void resizeOverdrawTarget(int width, int height)
+{
+    if (width == g_OverdrawWidth && height == g_OverdrawHeight) {
+        return;
+    }
+    g_OverdrawWidth = width;
+    g_OverdrawHeight = height;
+    g_OverdrawPixels.resize((size_t)width * height);
+
+    glBindTexture(GL_TEXTURE_2D, g_OverdrawTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, width, height, 0, GL_RED, GL_FLOAT, NULL);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, g_OverdrawDepth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    GLint previous = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previous);
+    glBindFramebuffer(GL_FRAMEBUFFER, g_OverdrawFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, g_OverdrawTexture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, g_OverdrawDepth);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "ERROR: Overdraw framebuffer incomplete" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, previous);
+    resetStateCache(); // The texture binding was set directly
+}
+
+// Read the layer counts back and print max/mean layers and total fragments
+float reportOverdrawStats()
+{
+    glBindTexture(GL_TEXTURE_2D, g_OverdrawTexture);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RED, GL_FLOAT, g_OverdrawPixels.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    double fragments = 0.0;
+    float maxLayers = 0.0f;
+    size_t covered = 0;
+    for (float n : g_OverdrawPixels) {
+        fragments += n;
+        if (n > maxLayers) {
+            maxLayers = n;
+        }
+        if (n > 0.0f) {
+            covered++;
+        }
+    }
+
+    size_t pixels = g_OverdrawPixels.size();
+    std::cout << std::fixed << std::setprecision(2)
+              << "Overdraw: max=" << maxLayers
+              << " mean=" << (pixels ? fragments / pixels : 0.0)
+              << " mean(covered)=" << (covered ? fragments / covered : 0.0)
+              << " fragments=" << (long long)fragments
+              << " (" << covered << "/" << pixels << " px covered)"
+              << std::defaultfloat << std::endl;
+    return maxLayers;
+}
+
+// Render scene() as an overdraw heatmap in place of the normal frame
+void drawOverdraw(void (*scene)())
+{
+    if (!initOverdraw()) {
+        scene();
+        return;
+    }
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    resizeOverdrawTarget(viewport[2], viewport[3]);
+
+    GLint previousFBO = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFBO);
+
+    glPushAttrib(GL_COLOR_BUFFER_BIT | GL_ENABLE_BIT | GL_VIEWPORT_BIT);
+    glBindFramebuffer(GL_FRAMEBUFFER, g_OverdrawFBO);
+    glViewport(0, 0, viewport[2], viewport[3]);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+    glUseProgram(g_OverdrawCountProgram);
+
+    beginLayeredFrame();
+    scene();
+    endLayeredFrame();
+
+    glUseProgram(0);
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFBO);
+    glPopAttrib();
+
+    float maxLayers = reportOverdrawStats();
+
+    // Show the heatmap as a full-screen quad in clip space
+    glPushAttrib(GL_ENABLE_BIT);
+    glDisable(GL_BLEND);
+    glUseProgram(g_OverdrawHeatmapProgram);
+    glUniform1i(glGetUniformLocation(g_OverdrawHeatmapProgram, "layers"), 0);
+    glUniform1f(glGetUniformLocation(g_OverdrawHeatmapProgram, "maxLayers"), maxLayers);
+    glBindTexture(GL_TEXTURE_2D, g_OverdrawTexture);
+    glBegin(GL_QUADS);
+    glVertex2f(-1.0f, -1.0f);
+    glVertex2f(1.0f, -1.0f);
+    glVertex2f(1.0f, 1.0f);
+    glVertex2f(-1.0f, 1.0f);
+    glEnd();
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(0);
+    glPopAttrib();
+    resetStateCache(); // Blending and the texture binding were set directly
+}
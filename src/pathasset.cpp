@@ -0,0 +1,285 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+// PATH ASSETS
+// Named Bezier paths (P0, C, P1, C, P2, ... as x, y floats) kept in one binary
+// file per scene instead of in its source, so an edited path shows up without
+// rebuilding. The file is a header, a table of entries (name, first point,
+// point count) and then every point, in native byte order. It is mmap'ed and
+// the points are used where they are. Writers go through a temporary file and
+// a rename, like the .texcache of refimage.cpp, so a reader never maps half a
+// file: the Bezier editor (debug.cpp) saves the path it edits, and
+// ./build/trace --out writes traced contours.
+//
+// An inotify watch on the file's directory sees it being replaced and
+// pollPathAssets() maps it again. Each path has a generation that only
+// changes when its points do, so pathFigure() (figure.cpp) generates again the
+// Figures of the paths that changed and nothing else.
+
+typedef struct {
+    char magic[8]; // "MGPATHS1"
+    uint32_t paths;
+    uint32_t points; // x, y pairs after the table
+} PathAssetHeader;
+
+const size_t PATH_ASSET_NAME = 48;
+
+typedef struct {
+    char name[PATH_ASSET_NAME]; // NUL-terminated
+    uint32_t first; // Index of its first point
+    uint32_t count; // Points
+} PathAssetEntry;
+
+typedef struct {
+    const float* xy; // Into the mapping
+    uint32_t count;
+    unsigned generation;
+} PathAsset;
+
+typedef struct {
+    std::string name;
+    std::vector<float> xy;
+} NamedPath;
+
+typedef struct {
+    std::string filename; // Empty until openPathAssets()
+    void* mapping;
+    size_t size;
+    std::map<std::string, PathAsset> paths;
+    unsigned generations; // Last generation handed out
+    int inotify; // -1 when not watching
+    std::map<std::string, std::vector<float>> defaults; // Compiled-in points, for the editor
+} PathAssetFile;
+
+PathAssetFile g_PathAssets = { "", NULL, 0, {}, 0, -1, {} };
+
+// Writes paths to filename through a temporary file
+bool writePathAssets(const std::string& filename, const std::vector<NamedPath>& paths)
+{
+    PathAssetHeader header = {};
+    memcpy(header.magic, "MGPATHS1", 8);
+    header.paths = (uint32_t)paths.size();
+    std::vector<PathAssetEntry> table(paths.size());
+    for (size_t i = 0; i < paths.size(); i++) {
+        if (paths[i].name.size() >= PATH_ASSET_NAME) {
+            std::cerr << "ERROR: Path name '" << paths[i].name << "' is longer than "
+                      << PATH_ASSET_NAME - 1 << " characters" << std::endl;
+            return false;
+        }
+        memcpy(table[i].name, paths[i].name.c_str(), paths[i].name.size() + 1);
+        table[i].first = header.points;
+        table[i].count = (uint32_t)(paths[i].xy.size() / 2);
+        header.points += table[i].count;
+    }
+
+    std::string temporary = filename + ".tmp";
+    FILE* file = fopen(temporary.c_str(), "wb");
+    if (!file) {
+        std::cerr << "ERROR: Could not write '" << temporary << "'" << std::endl;
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1
+        && fwrite(table.data(), sizeof(PathAssetEntry), table.size(), file) == table.size();
+    for (const NamedPath& path : paths) {
+        ok = ok && fwrite(path.xy.data(), sizeof(float), path.xy.size(), file) == path.xy.size();
+    }
+    ok = fclose(file) == 0 && ok;
+    if (!ok || rename(temporary.c_str(), filename.c_str()) != 0) {
+        std::cerr << "ERROR: Could not write '" << filename << "'" << std::endl;
+        remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+#ifndef _WIN32
+// Maps filename and fills paths with pointers into it; generations are left at 0
+bool mapPathAssets(const std::string& filename, void*& mapping, size_t& size, std::map<std::string, PathAsset>& paths)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false; // Not written yet: the compiled-in points are used
+    }
+    struct stat st;
+    void* file = MAP_FAILED;
+    bool header = fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(PathAssetHeader);
+    if (header) {
+        file = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (file == MAP_FAILED) {
+        std::cerr << "ERROR: " << (header ? "Could not map path assets '" : "Not a path asset file '")
+                  << filename << "'" << std::endl;
+        return false;
+    }
+
+    const PathAssetHeader* head = (const PathAssetHeader*)file;
+    const PathAssetEntry* table = (const PathAssetEntry*)(head + 1);
+    const float* points = (const float*)(table + head->paths);
+    bool valid = memcmp(head->magic, "MGPATHS1", 8) == 0
+        && (size_t)st.st_size == sizeof(PathAssetHeader) + head->paths * sizeof(PathAssetEntry) + head->points * 2 * sizeof(float);
+    for (uint32_t i = 0; valid && i < head->paths; i++) {
+        const PathAssetEntry& entry = table[i];
+        valid = memchr(entry.name, 0, PATH_ASSET_NAME) != NULL
+            && entry.first <= head->points && entry.count <= head->points - entry.first;
+        if (valid) {
+            paths[entry.name] = { points + 2 * entry.first, entry.count, 0 };
+        }
+    }
+    if (!valid) {
+        std::cerr << "ERROR: '" << filename << "' is not a valid path asset file" << std::endl;
+        munmap(file, st.st_size);
+        paths.clear();
+        return false;
+    }
+    mapping = file;
+    size = st.st_size;
+    return true;
+}
+
+// Maps the file again. Paths keep their generation unless their points
+// changed. Returns true if any path changed, appeared or went away.
+bool reloadPathAssets()
+{
+    PathAssetFile& assets = g_PathAssets;
+    void* mapping = NULL;
+    size_t size = 0;
+    std::map<std::string, PathAsset> paths;
+    mapPathAssets(assets.filename, mapping, size, paths);
+
+    bool changed = paths.size() != assets.paths.size();
+    for (auto it = paths.begin(); it != paths.end(); ++it) {
+        PathAsset& path = it->second;
+        auto old = assets.paths.find(it->first);
+        if (old != assets.paths.end() && old->second.count == path.count
+            && memcmp(old->second.xy, path.xy, path.count * 2 * sizeof(float)) == 0) {
+            path.generation = old->second.generation;
+        } else {
+            path.generation = ++assets.generations;
+            changed = true;
+        }
+    }
+    if (assets.mapping) {
+        munmap(assets.mapping, assets.size);
+    }
+    assets.mapping = mapping;
+    assets.size = size;
+    assets.paths.swap(paths);
+    return changed;
+}
+#else
+bool reloadPathAssets()
+{
+    return false;
+}
+#endif
+
+// Loads the scene's path assets, if the file exists yet
+void openPathAssets(const char* filename)
+{
+    g_PathAssets.filename = filename;
+    reloadPathAssets();
+}
+
+// Watches for new versions of the open file; only worth it when something
+// calls pollPathAssets() (windowed runs)
+void watchPathAssetFile()
+{
+#ifdef __linux__
+    if (g_PathAssets.inotify < 0 && !g_PathAssets.filename.empty()) {
+        std::string directory = g_PathAssets.filename;
+        size_t slash = directory.rfind('/');
+        directory = slash == std::string::npos ? "." : directory.substr(0, slash + 1);
+        g_PathAssets.inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (g_PathAssets.inotify >= 0
+            && inotify_add_watch(g_PathAssets.inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+            close(g_PathAssets.inotify);
+            g_PathAssets.inotify = -1;
+        }
+    }
+#endif
+}
+
+// Non-blocking. True when the file was replaced and a path changed with it.
+bool pollPathAssets()
+{
+    bool replaced = false;
+#ifdef __linux__
+    if (g_PathAssets.inotify < 0) {
+        return false;
+    }
+    std::string base = g_PathAssets.filename.substr(g_PathAssets.filename.rfind('/') + 1);
+    alignas(struct inotify_event) char buffer[4096];
+    ssize_t length;
+    while ((length = read(g_PathAssets.inotify, buffer, sizeof(buffer))) > 0) {
+        for (char* p = buffer; p < buffer + length;) {
+            const struct inotify_event* event = (const struct inotify_event*)p;
+            if (event->len > 0 && base == event->name) {
+                replaced = true;
+            }
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+#endif
+    return replaced && reloadPathAssets();
+}
+
+const PathAsset* findPathAsset(const std::string& name)
+{
+    auto it = g_PathAssets.paths.find(name);
+    return it == g_PathAssets.paths.end() ? NULL : &it->second;
+}
+
+// Points of the path named name: from the file, or else as compiled in
+std::vector<float> pathAssetPoints(const std::string& name)
+{
+    const PathAsset* path = findPathAsset(name);
+    if (path) {
+        return std::vector<float>(path->xy, path->xy + 2 * path->count);
+    }
+    auto it = g_PathAssets.defaults.find(name);
+    return it == g_PathAssets.defaults.end() ? std::vector<float>() : it->second;
+}
+
+void setPathDefault(const std::string& name, const float* xy, size_t count)
+{
+    g_PathAssets.defaults[name].assign(xy, xy + 2 * count);
+}
+
+// Replaces (or adds) one path in the open file and reloads it right away;
+// the other paths are written back unchanged
+bool savePathAsset(const std::string& name, const float* xy, size_t count)
+{
+    if (g_PathAssets.filename.empty()) {
+        return false;
+    }
+    std::vector<NamedPath> paths;
+    for (auto it = g_PathAssets.paths.begin(); it != g_PathAssets.paths.end(); ++it) {
+        const PathAsset& path = it->second;
+        if (it->first != name) {
+            paths.push_back({ it->first, std::vector<float>(path.xy, path.xy + 2 * path.count) });
+        }
+    }
+    paths.push_back({ name, std::vector<float>(xy, xy + 2 * count) });
+    if (!writePathAssets(g_PathAssets.filename, paths)) {
+        return false;
+    }
+    reloadPathAssets();
+    return true;
+}
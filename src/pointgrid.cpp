@@ -0,0 +1,104 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// POINT GRID
+// Uniform grid over an array of points (x, y pairs) for picking. Each cell
+// lists the indices of the points inside it; cells are keyed by their integer
+// coordinates, so the grid needs no bounds and empty space costs nothing.
+// Appending or moving a point touches one or two cells, and a query only the
+// cells within its radius, so neither depends on how long the array is. The
+// cell size doubles as the spacing of the snapping grid.
+typedef struct {
+    float cell; // World units per cell
+    std::unordered_map<uint64_t, std::vector<int>> cells;
+    size_t count; // Points indexed, always the first ones of the array
+} PointGrid;
+
+uint64_t pointGridKey(int cx, int cy)
+{
+    return ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy;
+}
+
+int pointGridCoord(const PointGrid& grid, float v)
+{
+    return (int)floorf(v / grid.cell);
+}
+
+void clearPointGrid(PointGrid& grid)
+{
+    grid.cells.clear();
+    grid.count = 0;
+}
+
+// Index the points past grid.count, up to count
+void appendPointGrid(PointGrid& grid, const float* xy, size_t count)
+{
+    for (size_t k = grid.count; k < count; k++) {
+        uint64_t key = pointGridKey(pointGridCoord(grid, xy[2 * k]), pointGridCoord(grid, xy[2 * k + 1]));
+        grid.cells[key].push_back((int)k);
+    }
+    grid.count = std::max(grid.count, count);
+}
+
+// Point k goes from (ox, oy) to (nx, ny); only changes cell if it has to
+void movePointGrid(PointGrid& grid, int k, float ox, float oy, float nx, float ny)
+{
+    uint64_t from = pointGridKey(pointGridCoord(grid, ox), pointGridCoord(grid, oy));
+    uint64_t to = pointGridKey(pointGridCoord(grid, nx), pointGridCoord(grid, ny));
+    if (from == to) {
+        return;
+    }
+    auto it = grid.cells.find(from);
+    if (it != grid.cells.end()) {
+        std::vector<int>& list = it->second;
+        for (size_t i = 0; i < list.size(); i++) {
+            if (list[i] == k) {
+                list[i] = list.back();
+                list.pop_back();
+                break;
+            }
+        }
+        if (list.empty()) {
+            grid.cells.erase(it);
+        }
+    }
+    grid.cells[to].push_back(k);
+}
+
+// Nearest indexed point to (x, y) within radius, other than exclude; -1 if none
+int nearestPointGrid(const PointGrid& grid, const float* xy, float x, float y, float radius, int exclude = -1)
+{
+    int x0 = pointGridCoord(grid, x - radius), x1 = pointGridCoord(grid, x + radius);
+    int y0 = pointGridCoord(grid, y - radius), y1 = pointGridCoord(grid, y + radius);
+    int best = -1;
+    float bestDistance = radius * radius;
+    for (int cy = y0; cy <= y1; cy++) {
+        for (int cx = x0; cx <= x1; cx++) {
+            auto it = grid.cells.find(pointGridKey(cx, cy));
+            if (it == grid.cells.end()) {
+                continue;
+            }
+            for (int k : it->second) {
+                float dx = xy[2 * k] - x, dy = xy[2 * k + 1] - y;
+                float distance = dx * dx + dy * dy;
+                // Ties go to the lowest index, whatever order the cell is in
+                if (k != exclude && (distance < bestDistance || (distance == bestDistance && best >= 0 && k < best))) {
+                    best = k;
+                    bestDistance = distance;
+                }
+            }
+        }
+    }
+    return best;
+}
+
+// Nearest grid line crossing
+float snapPointGrid(const PointGrid& grid, float v)
+{
+    return roundf(v / grid.cell) * grid.cell;
+}
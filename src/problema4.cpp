@@ -12,282 +12,21 @@
 #define M_PI 3.14159265
 #endif
 
-// --- Estructuras ---
-
-typedef struct {
-    std::vector<float> X;
-    std::vector<float> Y;
-    size_t size;
-} Figure;
-
-typedef struct {
-    float r, g, b;
-} ColorRGB;
-
-typedef enum {
-    AREA,
-    AREAFIX,
-    BORDER,
-    POINTS
-} DrawMode;
-
-typedef struct {
-    float x;
-    float y;
-} Point;
-
-// --- Constantes ---
-
-int SEGMENTS = 100;
-ColorRGB WHITE = { 1.0f, 1.0f, 1.0f };
-ColorRGB BLACK = { 0.0f, 0.0f, 0.0f };
-ColorRGB RED = { 1.0f, 0.0f, 0.0f };
-ColorRGB GREEN = { 0.0f, 1.0f, 0.0f };
-ColorRGB BLUE = { 0.0f, 0.0f, 1.0f };
-ColorRGB ORANGE = { 0.8f, 0.5f, 0.2f };
-ColorRGB YELLOW = { 1.0f, 0.647f, 0.0f };
-ColorRGB LIGHTBLUE = { 0.529f, 0.808f, 0.922f };
-
-// --- Funciones auxiliares ---
-
-Figure newFigure(std::vector<float>& X, std::vector<float>& Y)
-{
-    if (X.size() != Y.size()) {
-        throw std::invalid_argument("the sizes do not match");
-    }
-    return { X, Y, X.size() };
-}
-
-Figure pointsToFigure(std::vector<Point> points)
-{
-    std::vector<float> X(points.size());
-    std::vector<float> Y(points.size());
-    for (size_t i = 0; i < points.size(); i++) {
-        X[i] = points[i].x;
-        Y[i] = points[i].y;
-    }
-    return newFigure(X, Y);
-}
-
-// --- Funciones de dibujado ---
-
-void draw(DrawMode mode, Figure fig, float w = 3, ColorRGB c = BLACK)
-{
-    glColor3f(c.r, c.g, c.b);
-
-    switch (mode) {
-    case AREA:
-        glBegin(GL_POLYGON);
-        break;
-    case AREAFIX:
-        glBegin(GL_POLYGON);
-        glVertex2f(0, 0);
-        break;
-    case BORDER:
-        glLineWidth(w);
-        glBegin(GL_LINE_STRIP);
-        break;
-    case POINTS:
-        glPointSize(w);
-        glBegin(GL_POINTS);
-        break;
-    }
-
-    for (size_t i = 0; i < fig.size; i++) {
-        glVertex2f(fig.X[i], fig.Y[i]);
-    }
-    glEnd();
-    glLineWidth(1.0f);
-    glPointSize(1.0f);
-}
-
-void drawWithTrans(DrawMode mode, Figure fig, float cx, float cy, float w = 3,
-    ColorRGB c = BLACK)
-{
-    glPushMatrix();
-    glTranslatef(cx, cy, 0.0f);
-    draw(mode, fig, w, c);
-    glPopMatrix();
-}
-
-void drawWithRotate(DrawMode mode, Figure fig, float angle, float w = 3, ColorRGB c = BLACK)
-{
-    glPushMatrix();
-    glRotatef(angle, 0.0f, 0.0f, 1.0f);
-    draw(mode, fig, w, c);
-    glPopMatrix();
-}
-
-void drawWithScale(DrawMode mode, Figure fig, float scaleX, float scaleY, float w = 3, ColorRGB c = BLACK)
-{
-    glPushMatrix();
-    glScalef(scaleX, scaleY, 1.0f);
-    draw(mode, fig, w, c);
-    glPopMatrix();
-}
-
-void drawWithTransScale(DrawMode mode, Figure fig, float cx, float cy, float scaleX, float scaleY, float w = 3, ColorRGB c = BLACK)
-{
-    glPushMatrix();
-    glTranslatef(cx, cy, 0.0f);
-    glScalef(scaleX, scaleY, 1.0f);
-    draw(mode, fig, w, c);
-    glPopMatrix();
-}
-
-void drawFlower(DrawMode mode, Figure fig, int n, float r, float scaleX, float scaleY, bool skip = false, float w = 3, ColorRGB c = BLACK)
-{
-    float t1 = 0.0;
-    if (skip)
-        t1 = M_PI / n;
-    for (int i = 0; i < n; i++) {
-        glPushMatrix();
-        float theta = 2 * M_PI * i / n + t1;
-        glTranslatef(r * cosf(theta), r * sinf(theta), 0.0f);
-        glRotatef(theta * 180.0f / M_PI, 0, 0, 1);
-        glScalef(scaleX, scaleY, 1.0f);
-        draw(mode, fig, w, c);
-        glPopMatrix();
-    }
-}
-
-// --- Figuras comunes ---
-
-Point getBezierPoint(Point p0, Point p1, Point p2, float t)
-{
-    Point p;
-    float u = 1.0f - t;
-    float tt = t * t;
-    float uu = u * u;
-    float u2t = 2.0f * u * t;
-
-    p.x = uu * p0.x + u2t * p1.x + tt * p2.x;
-    p.y = uu * p0.y + u2t * p1.y + tt * p2.y;
-
-    return p;
-}
-
-Figure genBezier(const std::vector<Point> points)
-{
-    if (points.size() < 3 || points.size() % 2 == 0) {
-        return Figure {};
-    }
-    int n = SEGMENTS;
-    int k = (points.size() - 1) / 2;
-    std::vector<float> X(k * n + 1);
-    std::vector<float> Y(k * n + 1);
-    X[0] = points[0].x;
-    Y[0] = points[0].y;
-    for (size_t i = 0; i < points.size() - 1; i += 2) {
-        Point p0 = points[i];
-        Point p1 = points[i + 1];
-        Point p2 = points[i + 2];
-
-        for (int j = 1; j <= n; ++j) {
-            float t = (float)j / n;
-            Point p = getBezierPoint(p0, p1, p2, t);
-            int l = n * (i / 2) + j;
-            X[l] = p.x;
-            Y[l] = p.y;
-        }
-    }
-    return newFigure(X, Y);
-}
+// Con -DSCENE_MODULE solo queda drawShape(), para ./build/host (scenemodule.cpp)
+#ifndef SCENE_MODULE
+#include "headless.cpp"
 
-Figure genPoly(int n, bool skip = false)
-{
-    float t1 = 0.0;
-    if (skip)
-        t1 = -M_PI / 2 - M_PI / n;
-    std::vector<float> X(n + 1);
-    std::vector<float> Y(n + 1);
-    for (int i = 0; i < n + 1; i++) {
-        float t = 2 * M_PI * i / n;
-        X[i] = cosf(t + t1);
-        Y[i] = sinf(t + t1);
-    }
-    return newFigure(X, Y);
-}
-
-Figure genCircle(float t1 = 0, float t2 = 2 * M_PI)
-{
-    int n = SEGMENTS;
-    std::vector<float> X(n);
-    std::vector<float> Y(n);
-    for (int i = 0; i < n; i++) {
-        float t = t1 + (t2 - t1) * i / (n - 1);
-        X[i] = cosf(t);
-        Y[i] = sinf(t);
-    }
-    return newFigure(X, Y);
-}
-
-Figure genHoja()
-{
-    int n = SEGMENTS;
-    std::vector<float> X(2 * n);
-    std::vector<float> Y(2 * n);
-    for (int i = 0; i < n; i++) {
-        float t = -1.0 + 2.0 * i / (n - 1);
-        X[i] = t;
-        Y[i] = sinf(M_PI * (t + 1) / 2);
-    }
-    for (int i = 0; i < n; i++) {
-        float t = -1.0 + 2.0 * i / (n - 1);
-        X[n + i] = -t;
-        Y[n + i] = -sinf(M_PI * (t + 1) / 2);
-    }
-    return newFigure(X, Y);
-}
-
-Figure genCardoid(float t1 = 0, float t2 = 2 * M_PI)
-{
-    int n = SEGMENTS;
-    float a = 0.5;
-    std::vector<float> X(n);
-    std::vector<float> Y(n);
-    for (int i = 0; i < n; i++) {
-        float t = t1 + (t2 - t1) * i / (n - 1);
-        X[i] = (a - a * sinf(t)) * cosf(t);
-        Y[i] = (a - a * sinf(t)) * sinf(t);
-    }
-    return newFigure(X, Y);
-}
-
-Figure genRose(int k, bool skip = false, float t1 = 0, float t2 = 2 * M_PI)
-{
-    int n = SEGMENTS;
-    std::vector<float> X(n);
-    std::vector<float> Y(n);
-    for (int i = 0; i < n; i++) {
-        float t = t1 + (t2 - t1) * i / (n - 1);
-        if (skip) {
-            X[i] = sinf(k * t) * cosf(t);
-            Y[i] = sinf(k * t) * sinf(t);
-        } else {
-            X[i] = cosf(k * t) * cosf(t);
-            Y[i] = cosf(k * t) * sinf(t);
-        }
-    }
-    return newFigure(X, Y);
-}
+// DEBUG
+#include "debug.cpp"
+#endif
 
-Figure genLemniscate(float t1 = 0, float t2 = 2 * M_PI)
-{
-    int n = SEGMENTS;
-    float a = 1.0;
-    std::vector<float> X(n);
-    std::vector<float> Y(n);
-    for (int i = 0; i < n; i++) {
-        float t = t1 + (t2 - t1) * i / (n - 1);
-        X[i] = a * cosf(t) / (1 + pow(sinf(t), 2));
-        Y[i] = a * sinf(t) * cosf(t) / (1 + pow(sinf(t), 2));
-    }
-    return newFigure(X, Y);
-}
+#include "figure.cpp"
 
 // --- El programa ---
 
+ColorRGB AMBER = { 1.0f, 0.647f, 0.0f };
+ColorRGB LIGHTBLUE = { 0.529f, 0.808f, 0.922f };
+
 float r0 = 1.000;
 float r1 = 0.919;
 float r2 = 0.633;
@@ -564,96 +303,94 @@ std::vector<Point> espiralArea33B = {
     { -0.158159f, 0.70795f }
 };
 
-Figure circle = genCircle();
-
 void drawCuarto()
 {
-    drawWithScale(AREA, circle, r0, r0, 0, LIGHTBLUE);
-    drawWithScale(BORDER, circle, r0, r0, 2);
+    drawEllipse(AREA, 0, 0, r0, r0, 0, LIGHTBLUE);
+    drawEllipse(BORDER, 0, 0, r0, r0, 2);
     int n = 19;
     for (int i = 0; i < n; i++) {
-        glPushMatrix();
+        pushMatrix();
         float theta = 2 * M_PI * i / n;
-        glRotatef(theta * 180.0f / M_PI, 0, 0, 1);
-        draw(AREA, genBezier(circulo41B), 0, YELLOW);
-        draw(BORDER, genBezier(circulo41B), 2);
-        draw(AREA, genBezier(circulo42B), 0, RED);
-        draw(BORDER, genBezier(circulo42B), 2);
-        draw(AREA, genBezier(circulo43B), 0, LIGHTBLUE);
-        draw(BORDER, genBezier(circulo43B), 2);
-        glPopMatrix();
+        rotate2D(theta * 180.0f / M_PI);
+        drawBezier(AREA, circulo41B, 0, AMBER);
+        drawBezier(BORDER, circulo41B, 2);
+        drawBezier(AREA, circulo42B, 0, RED);
+        drawBezier(BORDER, circulo42B, 2);
+        drawBezier(AREA, circulo43B, 0, LIGHTBLUE);
+        drawBezier(BORDER, circulo43B, 2);
+        popMatrix();
     }
 }
 
 void drawTercero()
 {
-    drawWithScale(AREA, circle, r1, r1, 0, RED);
+    drawEllipse(AREA, 0, 0, r1, r1, 0, RED);
     int n = 4;
     for (int i = 0; i < n; i++) {
-        glPushMatrix();
+        pushMatrix();
         float theta = 2 * M_PI * i / n;
-        glRotatef(theta * 180.0f / M_PI, 0, 0, 1);
-        draw(AREA, genBezier(circulo31B), 0, YELLOW);
-        draw(BORDER, genBezier(circulo31B), 5);
-        draw(AREA, genBezier(circulo32B), 0, WHITE);
-        draw(BORDER, genBezier(circulo32B), 5);
-        draw(AREA, genBezier(circulo33B), 0, LIGHTBLUE);
-        draw(BORDER, genBezier(circulo33B), 5);
-
-        draw(AREA, genBezier(espiralArea31B), 0, LIGHTBLUE);
-        draw(AREA, genBezier(espiralArea32B), 0, LIGHTBLUE);
-        draw(AREA, genBezier(espiralArea33B), 0, LIGHTBLUE);
-        draw(BORDER, genBezier(espiral31B), 5);
-        draw(BORDER, genBezier(espiral32B), 4);
-        draw(BORDER, genBezier(espiral33B), 4);
-        draw(BORDER, genBezier(espiral34B), 5);
-        glPopMatrix();
+        rotate2D(theta * 180.0f / M_PI);
+        drawBezier(AREA, circulo31B, 0, AMBER);
+        drawBezier(BORDER, circulo31B, 5);
+        drawBezier(AREA, circulo32B, 0, WHITE);
+        drawBezier(BORDER, circulo32B, 5);
+        drawBezier(AREA, circulo33B, 0, LIGHTBLUE);
+        drawBezier(BORDER, circulo33B, 5);
+
+        drawBezier(AREA, espiralArea31B, 0, LIGHTBLUE);
+        drawBezier(AREA, espiralArea32B, 0, LIGHTBLUE);
+        drawBezier(AREA, espiralArea33B, 0, LIGHTBLUE);
+        drawBezier(BORDER, espiral31B, 5);
+        drawBezier(BORDER, espiral32B, 4);
+        drawBezier(BORDER, espiral33B, 4);
+        drawBezier(BORDER, espiral34B, 5);
+        popMatrix();
     }
-    drawWithScale(BORDER, circle, r1, r1, 3);
+    drawEllipse(BORDER, 0, 0, r1, r1, 3);
 }
 
 void drawSegundo()
 {
-    drawWithScale(AREA, circle, r2, r2, 0, WHITE);
-    drawWithScale(BORDER, circle, r2, r2, 5);
+    drawEllipse(AREA, 0, 0, r2, r2, 0, WHITE);
+    drawEllipse(BORDER, 0, 0, r2, r2, 5);
     int n = 6;
     for (int i = 0; i < n; i++) {
-        glPushMatrix();
+        pushMatrix();
         float theta = 2 * M_PI * i / n;
-        glRotatef(theta * 180.0f / M_PI, 0, 0, 1);
-        draw(AREA, genBezier(circulo1B), 0, LIGHTBLUE);
-        draw(BORDER, genBezier(circulo1B));
-        draw(AREA, genBezier(circulo2B), 0, RED);
-        draw(BORDER, genBezier(circulo2B));
-        draw(AREA, genBezier(circulo3B), 0, YELLOW);
-        draw(BORDER, genBezier(circulo3B));
-        glPopMatrix();
+        rotate2D(theta * 180.0f / M_PI);
+        drawBezier(AREA, circulo1B, 0, LIGHTBLUE);
+        drawBezier(BORDER, circulo1B);
+        drawBezier(AREA, circulo2B, 0, RED);
+        drawBezier(BORDER, circulo2B);
+        drawBezier(AREA, circulo3B, 0, AMBER);
+        drawBezier(BORDER, circulo3B);
+        popMatrix();
     }
 }
 
 void drawPrimero()
 {
-    draw(AREA, genBezier(saliente1B), 0, RED);
-    draw(BORDER, genBezier(saliente1Bmod), 5);
-    draw(AREA, genBezier(saliente2B), 0, WHITE);
-    draw(BORDER, genBezier(saliente2Bmod), 4);
-    draw(AREA, genBezier(saliente3B), 0, YELLOW);
-    draw(BORDER, genBezier(saliente3Bmod), 4);
-    draw(BORDER, genBezier(espiral1B), 5);
-    draw(BORDER, genBezier(espiral2B), 4);
-    drawWithScale(AREA, circle, r5, r5, 4, WHITE);
-    drawWithScale(BORDER, circle, r5, r5, 4);
-    drawWithScale(AREA, circle, r6, r6, 0, RED);
-    drawWithTransScale(AREA, circle, -0.394, 0.038, 0.022, 0.022, 0, RED);
-    drawWithTransScale(AREA, circle, -0.389, 0.088, 0.01, 0.01, 0, RED);
+    drawBezier(AREA, saliente1B, 0, RED);
+    drawBezier(BORDER, saliente1Bmod, 5);
+    drawBezier(AREA, saliente2B, 0, WHITE);
+    drawBezier(BORDER, saliente2Bmod, 4);
+    drawBezier(AREA, saliente3B, 0, AMBER);
+    drawBezier(BORDER, saliente3Bmod, 4);
+    drawBezier(BORDER, espiral1B, 5);
+    drawBezier(BORDER, espiral2B, 4);
+    drawEllipse(AREA, 0, 0, r5, r5, 4, WHITE);
+    drawEllipse(BORDER, 0, 0, r5, r5, 4);
+    drawEllipse(AREA, 0, 0, r6, r6, 0, RED);
+    drawEllipse(AREA, -0.394, 0.038, 0.022, 0.022, 0, RED);
+    drawEllipse(AREA, -0.389, 0.088, 0.01, 0.01, 0, RED);
 }
 
 void drawPrincipal()
 {
-    drawWithScale(AREA, circle, r3, r3, 0, LIGHTBLUE);
-    drawWithScale(BORDER, circle, r3, r3, 3);
-    drawWithScale(AREA, circle, r4, r4, 0, YELLOW);
-    drawWithScale(BORDER, circle, r4, r4, 4);
+    drawEllipse(AREA, 0, 0, r3, r3, 0, LIGHTBLUE);
+    drawEllipse(BORDER, 0, 0, r3, r3, 3);
+    drawEllipse(AREA, 0, 0, r4, r4, 0, AMBER);
+    drawEllipse(BORDER, 0, 0, r4, r4, 4);
 }
 
 void drawShape()
@@ -664,75 +401,95 @@ void drawShape()
     drawPrincipal();
     // Primero
     drawPrimero();
-    glPushMatrix();
-    glScalef(1, -1, 1);
+    pushMatrix();
+    scale2D(1, -1);
     drawPrimero();
-    glPopMatrix();
-    glPushMatrix();
-    glScalef(-1, 1, 1);
+    popMatrix();
+    pushMatrix();
+    scale2D(-1, 1);
     drawPrimero();
-    glPopMatrix();
-    glPushMatrix();
-    glScalef(-1, -1, 1);
+    popMatrix();
+    pushMatrix();
+    scale2D(-1, -1);
     drawPrimero();
-    glPopMatrix();
+    popMatrix();
 }
 
+#ifndef SCENE_MODULE
 // --- Funciones de GLUT ---
 
 void display(void)
 {
     glClear(GL_COLOR_BUFFER_BIT);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    stateBlend(true);
+    stateBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    // DEBUG
+    if (g_OverdrawMode) {
+        drawOverdraw(drawShape);
+        presentFrame();
+        return;
+    }
 
     // Dibujado principal
+    beginLayeredFrame();
     drawShape();
+    endLayeredFrame();
 
-    glDisable(GL_BLEND);
-
-    glutSwapBuffers();
+    presentFrame();
 }
 
 void reshape(int w, int h)
 {
     glViewport(0, 0, (GLsizei)w, (GLsizei)h);
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
 
     // Mantener relacion 1/1
     float aspect = (float)w / (float)h;
     float viewExtent = 1.2f;
     if (w >= h) {
-        gluOrtho2D(-viewExtent * aspect, viewExtent * aspect, -viewExtent,
+        ortho2D(-viewExtent * aspect, viewExtent * aspect, -viewExtent,
             viewExtent);
     } else {
-        gluOrtho2D(-viewExtent, viewExtent, -viewExtent / aspect,
+        ortho2D(-viewExtent, viewExtent, -viewExtent / aspect,
             viewExtent / aspect);
     }
+}
 
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
+void init()
+{
+    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+    glEnable(GL_LINE_SMOOTH);
+    glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
 }
 
 int main(int argc, char* argv[])
 {
+    HeadlessOptions headless;
+    bool offscreen = parseHeadlessArgs(argc, argv, headless);
+    parseFigureArgs(argc, argv);
+    if (offscreen) {
+        if (headless.software) {
+            return runSoftware(headless, drawShape, 1.2f);
+        }
+        return runHeadless(headless, init, display, reshape);
+    }
+
     glutInit(&argc, argv);
-    glutInitDisplayMode(GLUT_RGBA | GLUT_DOUBLE | GLUT_DEPTH);
+    glutInitDisplayMode(GLUT_RGBA | GLUT_DOUBLE | GLUT_DEPTH | GLUT_STENCIL);
     glutInitWindowSize(600, 600);
     glutInitWindowPosition(100, 100);
     glutCreateWindow("Problema 4");
 
-    // Init
-
-    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
-    glEnable(GL_LINE_SMOOTH);
-    glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
+    init();
 
     // Register GLUT callbacks
     glutDisplayFunc(display);
     glutReshapeFunc(reshape);
 
+    // DEBUG
+    glutKeyboardFunc(keyboardCallback);
+
     glutMainLoop();
     return 0;
 }
+#endif // SCENE_MODULE
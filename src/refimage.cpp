@@ -0,0 +1,522 @@
+#pragma once
+
+#include <GL/glut.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "glstate.cpp"
+#include "headless.cpp"
+
+// REFERENCE IMAGE
+// The PNG is decoded on a worker thread while the scene is already being
+// drawn. Only the header is read up front: it sizes a pixel unpack buffer
+// (PBO) that is mapped on the GL thread, and the worker writes the decoded,
+// flipped image plus its whole mip pyramid (2x2 box filter) straight into it.
+// Without PBO support the pyramid lives in client memory instead.
+//
+// The texture only holds the levels the viewport needs: its level 0 is the
+// coarsest pyramid level at least as large as the image on screen. A small
+// texture is shown first; finer ones are built next to it in bands of rows,
+// a bounded amount per call, and replace it once complete, so a large scan
+// streams in over a few frames instead of stalling one. Drivers size a mip
+// chain from its level 0, so levels finer than needed are never allocated.
+//
+// The pyramid is also saved next to the PNG as <file>.texcache: a fixed
+// header (source mtime and size, image size) plus every level as uploaded.
+// When the header still matches the PNG, later launches mmap that file and
+// upload from it without decoding or filtering anything.
+//
+// Every image loaded stays loaded, keyed by filename: loading one again only
+// makes it the image drawn, with the levels it already has resident, so a
+// program that switches between scenes (gallery.cpp) decodes each image once.
+
+typedef struct {
+    char magic[8]; // "TEXCACHE"
+    int64_t sourceMtime; // Nanoseconds
+    int64_t sourceSize;
+    int32_t width, height, channels;
+    int32_t levels;
+} TexCacheHeader;
+
+typedef struct {
+    int width, height;
+    size_t offset; // Into the pyramid
+} RefImageLevel;
+
+typedef struct {
+    std::string filename;
+    int width, height, channels;
+    std::vector<RefImageLevel> levels; // 0 = full size
+    size_t pyramidSize;
+    GLuint pbo; // 0 without PBO support
+    unsigned char* mapped; // PBO memory the worker writes to
+    unsigned char* pixels; // Pyramid in client memory when there is no PBO
+    void* cache; // mmap of a valid .texcache, or NULL
+    size_t cacheSize;
+    std::future<bool> decoded;
+    std::chrono::steady_clock::time_point start;
+    bool pending; // Decoding
+    bool streaming; // Decoded, some needed levels not uploaded yet
+
+    // Upload state, on the GL thread
+    GLuint texture; // Complete, pyramid levels residentLevel.. as 0..
+    int residentLevel; // levels.size() while there is no texture yet
+    GLuint building; // Next texture, pyramid levels buildLevel.. as 0..
+    int buildLevel;
+    int uploadLevel; // Pyramid level being filled in building
+    int nextRow; // Rows of uploadLevel already uploaded
+} RefImageLoad;
+
+std::map<std::string, RefImageLoad> g_RefImages; // By filename; entries never move
+RefImageLoad* g_RefImage = NULL; // The one drawn, NULL for none
+const size_t REF_IMAGE_UPLOAD_BUDGET = 4 << 20; // Bytes per updateRefImage()
+
+std::string texCachePath(const std::string& filename)
+{
+    return filename + ".texcache";
+}
+
+// Level sizes and offsets, down to 1x1
+void planRefImageLevels(RefImageLoad& load)
+{
+    load.levels.clear();
+    load.pyramidSize = 0;
+    int w = load.width, h = load.height;
+    while (true) {
+        load.levels.push_back({ w, h, load.pyramidSize });
+        load.pyramidSize += (size_t)w * h * load.channels;
+        if (w == 1 && h == 1) {
+            break;
+        }
+        w = std::max(1, w / 2);
+        h = std::max(1, h / 2);
+    }
+}
+
+// 2x2 box filter from src (sw x sh) into dst (sw / 2 x sh / 2, at least 1).
+// The vertical average runs 16 bytes at a time with SSE2; it does not care
+// about channels, so any pixel format works.
+void downsampleLevel(const unsigned char* src, int sw, int sh, unsigned char* dst, int dw, int dh, int channels)
+{
+    size_t srcStride = (size_t)sw * channels;
+    std::vector<unsigned char> row(srcStride);
+    for (int y = 0; y < dh; y++) {
+        const unsigned char* a = src + (size_t)std::min(2 * y, sh - 1) * srcStride;
+        const unsigned char* b = src + (size_t)std::min(2 * y + 1, sh - 1) * srcStride;
+        size_t i = 0;
+#ifdef __SSE2__
+        for (; i + 16 <= srcStride; i += 16) {
+            __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+            __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+            _mm_storeu_si128((__m128i*)(row.data() + i), _mm_avg_epu8(va, vb));
+        }
+#endif
+        for (; i < srcStride; i++) {
+            row[i] = (unsigned char)((a[i] + b[i] + 1) >> 1);
+        }
+
+        unsigned char* out = dst + (size_t)y * dw * channels;
+        for (int x = 0; x < dw; x++) {
+            const unsigned char* p = row.data() + (size_t)std::min(2 * x, sw - 1) * channels;
+            const unsigned char* q = row.data() + (size_t)std::min(2 * x + 1, sw - 1) * channels;
+            for (int c = 0; c < channels; c++) {
+                out[x * channels + c] = (unsigned char)((p[c] + q[c]) >> 1);
+            }
+        }
+    }
+}
+
+void buildPyramid(const RefImageLoad& load, unsigned char* pyramid)
+{
+    for (size_t i = 1; i < load.levels.size(); i++) {
+        const RefImageLevel& s = load.levels[i - 1];
+        const RefImageLevel& d = load.levels[i];
+        downsampleLevel(pyramid + s.offset, s.width, s.height, pyramid + d.offset, d.width, d.height, load.channels);
+    }
+}
+
+#ifndef _WIN32
+int64_t statMtime(const struct stat& st)
+{
+    return (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+}
+
+// Map <filename>.texcache if it was written for the current version of filename
+bool mapTexCache(RefImageLoad& load)
+{
+    struct stat source;
+    if (stat(load.filename.c_str(), &source) != 0) {
+        return false;
+    }
+    int fd = open(texCachePath(load.filename).c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat cache;
+    void* mapping = MAP_FAILED;
+    if (fstat(fd, &cache) == 0 && (size_t)cache.st_size >= sizeof(TexCacheHeader)) {
+        mapping = mmap(NULL, cache.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+
+    const TexCacheHeader* header = (const TexCacheHeader*)mapping;
+    load.width = header->width;
+    load.height = header->height;
+    load.channels = header->channels;
+    bool valid = memcmp(header->magic, "TEXCACHE", 8) == 0
+        && header->sourceMtime == statMtime(source)
+        && header->sourceSize == (int64_t)source.st_size
+        && load.width > 0 && load.height > 0 && load.channels >= 1 && load.channels <= 4;
+    if (valid) {
+        planRefImageLevels(load);
+        valid = header->levels == (int32_t)load.levels.size()
+            && (size_t)cache.st_size == sizeof(TexCacheHeader) + load.pyramidSize;
+    }
+    if (!valid) {
+        munmap(mapping, cache.st_size);
+        return false;
+    }
+    load.cache = mapping;
+    load.cacheSize = cache.st_size;
+    return true;
+}
+
+// Called by the worker; written to a temporary file first so a reader never
+// maps a half-written cache
+void writeTexCache(const RefImageLoad& load, const unsigned char* pyramid)
+{
+    struct stat source;
+    if (stat(load.filename.c_str(), &source) != 0) {
+        return;
+    }
+    TexCacheHeader header = {};
+    memcpy(header.magic, "TEXCACHE", 8);
+    header.sourceMtime = statMtime(source);
+    header.sourceSize = source.st_size;
+    header.width = load.width;
+    header.height = load.height;
+    header.channels = load.channels;
+    header.levels = (int32_t)load.levels.size();
+
+    std::string path = texCachePath(load.filename);
+    std::string temporary = path + ".tmp";
+    FILE* file = fopen(temporary.c_str(), "wb");
+    if (!file) {
+        return;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1
+        && fwrite(pyramid, 1, load.pyramidSize, file) == load.pyramidSize;
+    ok = fclose(file) == 0 && ok;
+    if (!ok || rename(temporary.c_str(), path.c_str()) != 0) {
+        remove(temporary.c_str());
+    }
+}
+#else
+bool mapTexCache(RefImageLoad&)
+{
+    return false;
+}
+
+void writeTexCache(const RefImageLoad&, const unsigned char*)
+{
+}
+#endif
+
+bool pixelBuffersAvailable()
+{
+    const char* version = (const char*)glGetString(GL_VERSION);
+    int major = 0, minor = 0;
+    if (!version || sscanf(version, "%d.%d", &major, &minor) != 2) {
+        return false;
+    }
+    return major > 2 || (major == 2 && minor >= 1);
+}
+
+// Read the header and start decoding on a worker thread. False if the file
+// is missing or not an image stb can read.
+bool startRefImageDecode(RefImageLoad& load, const char* filename)
+{
+    load.start = std::chrono::steady_clock::now();
+    load.filename = filename;
+    load.cache = NULL;
+    load.pbo = 0;
+    load.mapped = NULL;
+    load.pixels = NULL;
+    load.texture = 0;
+    load.building = 0;
+    if (mapTexCache(load)) {
+        load.residentLevel = (int)load.levels.size();
+        load.pending = true;
+        return true;
+    }
+    if (!stbi_info(filename, &load.width, &load.height, &load.channels)) {
+        std::cerr << "ERROR: Could not load texture file '" << filename << "'"
+                  << std::endl;
+        std::cerr << "Reason: " << stbi_failure_reason() << std::endl;
+        return false;
+    }
+    if (load.channels == 2) {
+        // Should not happen with standard formats, but good to check
+        std::cerr << "ERROR: Unsupported number of channels (" << load.channels
+                  << ") in image '" << filename << "'" << std::endl;
+        return false;
+    }
+    planRefImageLevels(load);
+    load.residentLevel = (int)load.levels.size();
+
+    if (pixelBuffersAvailable()) {
+        glGenBuffers(1, &load.pbo);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, load.pbo);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, load.pyramidSize, NULL, GL_STREAM_DRAW);
+        load.mapped = (unsigned char*)glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0); // Other uploads must not read from it
+        if (!load.mapped) {
+            glDeleteBuffers(1, &load.pbo);
+            load.pbo = 0;
+        }
+    }
+    if (!load.mapped) {
+        load.pixels = (unsigned char*)malloc(load.pyramidSize);
+    }
+
+    stbi_set_flip_vertically_on_load(true);
+    load.decoded = std::async(std::launch::async, [&load]() {
+        int width, height, channels;
+        unsigned char* data = stbi_load(load.filename.c_str(), &width, &height, &channels, 0);
+        unsigned char* pyramid = load.mapped ? load.mapped : load.pixels;
+        if (!data || !pyramid) {
+            stbi_image_free(data);
+            return false;
+        }
+        memcpy(pyramid, data, load.levels[0].width * (size_t)load.levels[0].height * channels);
+        stbi_image_free(data);
+        buildPyramid(load, pyramid);
+        writeTexCache(load, pyramid);
+        return true;
+    });
+    load.pending = true;
+    return true;
+}
+
+// Makes filename the image drawn, decoding it first if it was not loaded
+// before. False if it cannot be loaded.
+bool startRefImageLoad(const char* filename)
+{
+    auto found = g_RefImages.find(filename);
+    if (found != g_RefImages.end()) {
+        g_RefImage = &found->second;
+        return true;
+    }
+    RefImageLoad& load = g_RefImages[filename];
+    if (!startRefImageDecode(load, filename)) {
+        g_RefImages.erase(filename);
+        return false;
+    }
+    g_RefImage = &load;
+    return true;
+}
+
+// No reference image; the loaded ones stay cached
+void clearRefImage()
+{
+    g_RefImage = NULL;
+}
+
+bool refImagePending()
+{
+    return g_RefImage && g_RefImage->pending;
+}
+
+bool refImageStreaming()
+{
+    return g_RefImage && g_RefImage->streaming;
+}
+
+bool refImageReady()
+{
+    if (!refImagePending()) {
+        return false;
+    }
+    return g_RefImage->cache || g_RefImage->decoded.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+// Drop the CPU/PBO copy once level 0 is on the GPU (or on failure)
+void releaseRefImageSource(RefImageLoad& load)
+{
+    if (load.pbo) {
+        glDeleteBuffers(1, &load.pbo);
+        load.pbo = 0;
+    }
+    free(load.pixels);
+    load.pixels = NULL;
+#ifndef _WIN32
+    if (load.cache) {
+        munmap(load.cache, load.cacheSize);
+        load.cache = NULL;
+    }
+#endif
+}
+
+// Coarsest level that still covers width x height pixels
+int neededRefImageLevel(const RefImageLoad& load, int width, int height)
+{
+    int level = 0;
+    while (level + 1 < (int)load.levels.size()
+        && load.levels[level + 1].width >= width && load.levels[level + 1].height >= height) {
+        level++;
+    }
+    return level;
+}
+
+size_t refImageLevelSize(const RefImageLoad& load, int level)
+{
+    return (size_t)load.levels[level].width * load.levels[level].height * load.channels;
+}
+
+// Allocate the texture for pyramid levels first.. and start filling it from
+// the coarsest one
+void startRefImageTexture(RefImageLoad& load, int first)
+{
+    glGenTextures(1, &load.building);
+    glBindTexture(GL_TEXTURE_2D, load.building);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)load.levels.size() - 1 - first);
+    GLenum formats[5] = { 0, GL_LUMINANCE, 0, GL_RGB, GL_RGBA };
+    for (int i = first; i < (int)load.levels.size(); i++) {
+        glTexImage2D(GL_TEXTURE_2D, i - first, formats[load.channels], load.levels[i].width, load.levels[i].height, 0,
+            formats[load.channels], GL_UNSIGNED_BYTE, NULL);
+    }
+    load.buildLevel = first;
+    load.uploadLevel = (int)load.levels.size() - 1;
+    load.nextRow = 0;
+}
+
+// Once the worker is done (or, with wait, after waiting for it), upload the
+// levels an image drawn at width x height pixels needs: all of them with
+// wait, else up to REF_IMAGE_UPLOAD_BUDGET bytes per call. Returns the
+// texture to draw, 0 while none is complete yet.
+GLuint updateRefImage(int width, int height, bool wait)
+{
+    if (!g_RefImage) {
+        return 0;
+    }
+    RefImageLoad& load = *g_RefImage;
+    if (load.pending) {
+        if (!wait && !refImageReady()) {
+            return 0;
+        }
+        load.pending = false;
+        bool ok = load.cache || load.decoded.get();
+        if (load.pbo) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, load.pbo);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            load.mapped = NULL;
+        }
+        if (!ok) {
+            std::cerr << "ERROR: Could not decode texture file '" << load.filename << "'"
+                      << std::endl;
+            releaseRefImageSource(load);
+            load.residentLevel = 0; // Nothing left to upload
+            return 0;
+        }
+    }
+
+    int target = neededRefImageLevel(load, width, height);
+    load.streaming = load.residentLevel > target;
+    if (!load.streaming) {
+        return load.texture;
+    }
+
+    size_t budget = wait ? SIZE_MAX : REF_IMAGE_UPLOAD_BUDGET;
+    if (!load.building) {
+        // Nothing on screen yet: begin with what fits in one call
+        int first = target;
+        while (!load.texture && first + 1 < (int)load.levels.size() && refImageLevelSize(load, first) > budget) {
+            first++;
+        }
+        startRefImageTexture(load, first);
+    }
+
+    GLenum formats[5] = { 0, GL_LUMINANCE, 0, GL_RGB, GL_RGBA };
+    GLenum format = formats[load.channels];
+    const unsigned char* source = load.pixels;
+    if (load.cache) {
+        source = (const unsigned char*)load.cache + sizeof(TexCacheHeader);
+    } else if (load.pbo) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, load.pbo);
+        source = NULL; // Offsets into the PBO
+    }
+    GLint alignment = 4;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // Rows are tightly packed
+    glBindTexture(GL_TEXTURE_2D, load.building);
+
+    while (load.uploadLevel >= load.buildLevel && budget > 0) {
+        const RefImageLevel& level = load.levels[load.uploadLevel];
+        size_t rowSize = (size_t)level.width * load.channels;
+        int rows = (int)std::min<size_t>(level.height - load.nextRow, std::max<size_t>(1, budget / rowSize));
+        glTexSubImage2D(GL_TEXTURE_2D, load.uploadLevel - load.buildLevel, 0, load.nextRow, level.width, rows,
+            format, GL_UNSIGNED_BYTE, source + level.offset + load.nextRow * rowSize);
+        budget -= std::min(budget, rows * rowSize);
+        load.nextRow += rows;
+        if (load.nextRow == level.height) {
+            load.uploadLevel--;
+            load.nextRow = 0;
+        }
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    resetStateCache();
+
+    if (load.uploadLevel < load.buildLevel) {
+        if (load.texture) {
+            glDeleteTextures(1, &load.texture);
+        }
+        load.texture = load.building;
+        load.residentLevel = load.buildLevel;
+        load.building = 0;
+    }
+    load.streaming = load.residentLevel > target;
+    if (load.residentLevel == target && !load.building) {
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - load.start).count();
+        const char* kinds[5] = { "", "Grayscale", "", "RGB", "RGBA" };
+        std::cout << "Loaded texture: " << load.filename << " (" << load.width << "x"
+                  << load.height << "), " << kinds[load.channels] << ", level " << target << " ("
+                  << load.levels[target].width << "x" << load.levels[target].height << ") resident after "
+                  << ms << " ms" << (load.cache ? " (cached)" : load.pbo ? " (PBO)" : "") << std::endl;
+    }
+    if (load.residentLevel == 0) {
+        releaseRefImageSource(load);
+    }
+    return load.texture;
+}
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <GL/glut.h>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <dlfcn.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+#include "compositor.cpp"
+#include "headless.cpp"
+
+// What the modules call into
+#include "disks.cpp"
+#include "figure.cpp"
+#include "sdf.cpp"
+#include "text.cpp"
+
+// SCENE MODULES
+// ./build/host build/<scene>.so (host.cpp)
+// A scene built with make build/<scene>.so is only its own code: with
+// -DSCENE_MODULE figure.cpp shrinks to figure.h, and the calls resolve to the
+// host's definitions, exported with -rdynamic, so there is one copy of every
+// cache and of the GL state behind them. The host watches the .so and, once
+// it is rebuilt, loads the new version and swaps its drawShape() in between
+// frames; the window, GL context, reference image, text atlas, GPU caches and
+// path assets all stay as they were. Each version is loaded from a copy with
+// its own name, so dlopen never returns one already loaded. g_SceneModule is
+// the module drawn; gallery.cpp keeps one per scene and swaps it in.
+// Scenes that do not draw through figure.cpp (disks.cpp, sdf.cpp, text.cpp)
+// work the same way, and may export what their GLUT program set up itself:
+// an init, the projection, the background, keys and a timer (scenemodule.h).
+
+typedef struct {
+    std::string path; // As built
+    void* handle;
+    void (*drawShape)();
+    unsigned version; // Loads so far
+    int inotify; // -1 when not watching
+    // Optional entry points (scenemodule.h), NULL when not exported
+    void (*init)(); // Cleared once run
+    void (*keyboard)(unsigned char);
+    void (*specialKey)(int);
+    void (*timer)();
+    int timerMs;
+    float viewExtent;
+    float background[3];
+} SceneModule;
+
+const float SCENE_VIEW_EXTENT = 1.2f; // The figure.cpp scenes'
+SceneModule g_SceneModule = { "", NULL, NULL, 0, -1, NULL, NULL, NULL, NULL, 0, SCENE_VIEW_EXTENT, { 1.0f, 1.0f, 1.0f } };
+unsigned g_SceneModuleCopies = 0; // Of every module: names the next copy
+unsigned g_SceneTimerRun = 0; // Timers of an earlier run stop at their next tick
+const int SCENE_MODULE_POLL_MS = 15;
+
+bool copyFile(const std::string& from, const std::string& to)
+{
+    FILE* in = fopen(from.c_str(), "rb");
+    if (!in) {
+        return false;
+    }
+    FILE* out = fopen(to.c_str(), "wb");
+    bool ok = out != NULL;
+    char buffer[1 << 16];
+    size_t length;
+    while (ok && (length = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        ok = fwrite(buffer, 1, length, out) == length;
+    }
+    fclose(in);
+    if (out) {
+        ok = fclose(out) == 0 && ok;
+    }
+    return ok;
+}
+
+// Loads the current build of the module; the previous one stays in use if
+// this one cannot be loaded
+bool loadSceneModule()
+{
+    SceneModule& module = g_SceneModule;
+    auto start = std::chrono::steady_clock::now();
+    std::string copy = "/tmp/scene-" + std::to_string(getpid()) + "-" + std::to_string(++g_SceneModuleCopies) + ".so";
+    if (!copyFile(module.path, copy)) {
+        std::cerr << "ERROR: Could not read scene module '" << module.path << "'" << std::endl;
+        remove(copy.c_str());
+        return false;
+    }
+    void* handle = dlopen(copy.c_str(), RTLD_NOW | RTLD_LOCAL);
+    remove(copy.c_str()); // Stays mapped
+    if (!handle) {
+        std::cerr << "ERROR: Could not load scene module: " << dlerror() << std::endl;
+        return false;
+    }
+    void (*drawShape)() = (void (*)())dlsym(handle, "sceneDrawShape");
+    if (!drawShape) {
+        std::cerr << "ERROR: '" << module.path << "' has no sceneDrawShape (built without -DSCENE_MODULE?)" << std::endl;
+        dlclose(handle);
+        return false;
+    }
+
+    if (module.handle) {
+        dlclose(module.handle);
+    }
+    module.handle = handle;
+    module.drawShape = drawShape;
+    module.version++;
+    module.init = (void (*)())dlsym(handle, "sceneInit");
+    module.keyboard = (void (*)(unsigned char))dlsym(handle, "sceneKeyboard");
+    module.specialKey = (void (*)(int))dlsym(handle, "sceneSpecialKey");
+    module.timer = (void (*)())dlsym(handle, "sceneTimer");
+    const int* timerMs = (const int*)dlsym(handle, "sceneTimerMs");
+    module.timerMs = module.timer && timerMs ? *timerMs : 0;
+    const float* viewExtent = (const float*)dlsym(handle, "sceneViewExtent");
+    module.viewExtent = viewExtent ? *viewExtent : SCENE_VIEW_EXTENT;
+    const float* background = (const float*)dlsym(handle, "sceneBackground");
+    for (int i = 0; i < 3; i++) {
+        module.background[i] = background ? background[i] : 1.0f;
+    }
+    forgetPathFigures(); // Their compiled-in points may have changed
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Scene module " << module.path << " v" << module.version << " loaded in " << ms << " ms" << std::endl;
+    return true;
+}
+
+bool openSceneModule(const char* path)
+{
+    g_SceneModule.path = path;
+#ifdef __linux__
+    std::string directory = g_SceneModule.path;
+    size_t slash = directory.rfind('/');
+    directory = slash == std::string::npos ? "." : directory.substr(0, slash + 1);
+    g_SceneModule.inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (g_SceneModule.inotify >= 0
+        && inotify_add_watch(g_SceneModule.inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        close(g_SceneModule.inotify);
+        g_SceneModule.inotify = -1;
+    }
+#endif
+    return loadSceneModule();
+}
+
+// Non-blocking. True when a rebuilt module was swapped in.
+bool pollSceneModule()
+{
+    bool rebuilt = false;
+#ifdef __linux__
+    if (g_SceneModule.inotify < 0) {
+        return false;
+    }
+    std::string base = g_SceneModule.path.substr(g_SceneModule.path.rfind('/') + 1);
+    alignas(struct inotify_event) char buffer[4096];
+    ssize_t length;
+    while ((length = read(g_SceneModule.inotify, buffer, sizeof(buffer))) > 0) {
+        for (char* p = buffer; p < buffer + length;) {
+            const struct inotify_event* event = (const struct inotify_event*)p;
+            if (event->len > 0 && base == event->name) {
+                rebuilt = true;
+            }
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+#endif
+    return rebuilt && loadSceneModule();
+}
+
+// The module changed what it draws
+void redrawSceneModule()
+{
+    invalidateStaticLayer();
+    requestRedisplay();
+}
+
+void sceneModuleTimer(int run)
+{
+    if (run != (int)g_SceneTimerRun || !g_SceneModule.timer) {
+        return;
+    }
+    glutTimerFunc(g_SceneModule.timerMs, sceneModuleTimer, run);
+    g_SceneModule.timer();
+    redrawSceneModule();
+}
+
+// Windowed: runs the sceneTimer() of the module in g_SceneModule from now
+// on, and stops the one of the module it replaced
+void startSceneModuleTimer()
+{
+    g_SceneTimerRun++;
+    if (!g_Headless && g_SceneModule.timer) {
+        glutTimerFunc(g_SceneModule.timerMs, sceneModuleTimer, (int)g_SceneTimerRun);
+    }
+}
+
+void pollSceneModuleFile(int)
+{
+    glutTimerFunc(SCENE_MODULE_POLL_MS, pollSceneModuleFile, 0);
+    if (pollSceneModule()) {
+        startSceneModuleTimer();
+        invalidateStaticLayer();
+        glutPostRedisplay();
+    }
+}
+
+// From init(); windowed only
+void watchSceneModule()
+{
+    if (!g_Headless && g_SceneModule.inotify >= 0) {
+        glutTimerFunc(SCENE_MODULE_POLL_MS, pollSceneModuleFile, 0);
+    }
+}
+
+void drawSceneModule()
+{
+    // Runs here, with the GL context current, even for a module opened before it
+    if (g_SceneModule.init) {
+        void (*init)() = g_SceneModule.init;
+        g_SceneModule.init = NULL;
+        init();
+    }
+    if (g_SceneModule.drawShape) {
+        g_SceneModule.drawShape();
+    }
+}
+
+// False when the module takes no keys, so they can go elsewhere
+bool sceneModuleKeyboard(unsigned char key)
+{
+    if (!g_SceneModule.keyboard) {
+        return false;
+    }
+    g_SceneModule.keyboard(key);
+    redrawSceneModule();
+    return true;
+}
+
+void sceneModuleSpecialKey(int key, int, int)
+{
+    if (g_SceneModule.specialKey) {
+        g_SceneModule.specialKey(key);
+        redrawSceneModule();
+    }
+}
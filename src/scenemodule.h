@@ -0,0 +1,23 @@
+#pragma once
+
+// SCENE MODULE ENTRY POINTS
+// What scenemodule.cpp looks up with dlsym in a scene built with
+// -DSCENE_MODULE. sceneDrawShape() is the scene's drawShape() and is always
+// there; a scene that needs more defines these itself with SCENE_EXPORT:
+//   void sceneInit()                    before the first drawShape() of each load
+//   const float sceneViewExtent         half the side of the square shown (1.2)
+//   const float sceneBackground[3]      clear color (white)
+//   void sceneKeyboard(unsigned char)   keys, instead of debug.cpp's
+//   void sceneSpecialKey(int)           GLUT_KEY_* keys
+//   void sceneTimer()                   every sceneTimerMs while it is shown, windowed
+//   const int sceneTimerMs
+#ifdef SCENE_MODULE
+#define SCENE_EXPORT extern "C" __attribute__((visibility("default")))
+
+void drawShape();
+
+SCENE_EXPORT void sceneDrawShape()
+{
+    drawShape();
+}
+#endif
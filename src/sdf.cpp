@@ -0,0 +1,208 @@
+#pragma once
+
+#include "sdf.h"
+
+// A scene module (scenemodule.cpp) uses the host's shader and switch
+#ifndef SCENE_MODULE
+
+#include <GL/glut.h>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "shaders.cpp"
+
+// SDF CIRCLES
+// Circles, ellipses, rings and their sectors drawn as a single quad each:
+// the fragment shader evaluates the signed distance to the shape and turns
+// it into coverage, so edges are anti-aliased without any tessellation.
+// Needs the compatibility profile (it uses the fixed-function matrices).
+// Off by default: the anti-aliased edges are not the pixels of the
+// tessellated circles. 'e' with debug.cpp loaded turns it on.
+bool g_SdfCircles = false;
+
+GLuint g_SdfProgram = 0;
+GLint g_SdfPixelSizeLocation = -1;
+
+const char* SDF_VS = "#version 120\n"
+                     "attribute vec2 corner;\n"
+                     "attribute vec4 shape;\n" // center, radii
+                     "attribute vec4 params;\n" // inner, stroke, t1, t2
+                     "attribute vec3 color;\n"
+                     "uniform vec2 pixelSize;\n" // Local units per pixel along x and y
+                     "varying vec2 local;\n"
+                     "varying vec2 radii;\n"
+                     "varying vec4 ring;\n"
+                     "varying vec3 tint;\n"
+                     "void main() {\n"
+                     "    vec2 pad = (params.y * 0.5 + 1.0) * pixelSize;\n"
+                     "    local = corner * (shape.zw + pad);\n"
+                     "    radii = shape.zw;\n"
+                     "    ring = params;\n"
+                     "    tint = color;\n"
+                     "    gl_Position = gl_ModelViewProjectionMatrix * vec4(shape.xy + local, 0.0, 1.0);\n"
+                     "}\n";
+
+const char* SDF_FS = "#version 120\n"
+                     "varying vec2 local;\n"
+                     "varying vec2 radii;\n"
+                     "varying vec4 ring;\n"
+                     "varying vec3 tint;\n"
+                     "float ellipse(vec2 p, vec2 r) {\n" // First-order distance estimate
+                     "    vec2 q = p / r;\n"
+                     "    float k = length(q);\n"
+                     "    float g = length(q / r);\n"
+                     "    return g > 0.0 ? (k - 1.0) * k / g : -min(r.x, r.y);\n"
+                     "}\n"
+                     "void main() {\n"
+                     "    float d = ellipse(local, radii);\n"
+                     "    if (ring.x > 0.0) d = max(d, -ellipse(local, radii * ring.x));\n"
+                     "    float arc = ring.w - ring.z;\n"
+                     "    if (arc < 6.2831) {\n"
+                     // Wedge centered on +x, in the circle the ellipse is scaled from
+                     "        vec2 q = local / radii * min(radii.x, radii.y);\n"
+                     "        float mid = 0.5 * (ring.z + ring.w), spread = 0.5 * arc;\n"
+                     "        vec2 p = vec2(cos(mid) * q.x + sin(mid) * q.y, cos(mid) * q.y - sin(mid) * q.x);\n"
+                     "        p.y = abs(p.y);\n"
+                     "        vec2 edge = vec2(cos(spread), sin(spread));\n"
+                     "        float side = edge.x * p.y - edge.y * p.x;\n"
+                     "        d = max(d, sign(side) * length(p - edge * max(dot(p, edge), 0.0)));\n"
+                     "    }\n"
+                     // Distance change per pixel on screen, in every direction, so the
+                     // stroke and the AA stay as wide under non-uniform scale
+                     "    float pixel = max(length(vec2(dFdx(d), dFdy(d))), 1e-6);\n"
+                     "    float dp = d / pixel;\n"
+                     "    if (ring.y > 0.0) dp = abs(dp) - 0.5 * ring.y;\n"
+                     "    float alpha = clamp(0.5 - dp, 0.0, 1.0);\n"
+                     "    if (alpha <= 0.0) discard;\n"
+                     "    gl_FragColor = vec4(tint, alpha);\n"
+                     "}\n";
+
+bool initSdf()
+{
+    if (g_SdfProgram) {
+        return true;
+    }
+    GLuint vs = compileShader(GL_VERTEX_SHADER, SDF_VS);
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, SDF_FS);
+    if (!vs || !fs) {
+        std::cerr << "ERROR: SDF circles unavailable" << std::endl;
+        g_SdfCircles = false;
+        return false;
+    }
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vs);
+    glAttachShader(program, fs);
+    glBindAttribLocation(program, 0, "corner");
+    glBindAttribLocation(program, 1, "shape");
+    glBindAttribLocation(program, 2, "params");
+    glBindAttribLocation(program, 3, "color");
+    glLinkProgram(program);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+
+    GLint ok = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        std::cerr << "ERROR: SDF program link failed" << std::endl;
+        glDeleteProgram(program);
+        g_SdfCircles = false;
+        return false;
+    }
+    g_SdfProgram = program;
+    g_SdfPixelSizeLocation = glGetUniformLocation(program, "pixelSize");
+    return true;
+}
+
+// False when disabled, unsupported, or another program (e.g. overdraw
+// counting) is in charge of the current draw calls
+bool sdfAvailable()
+{
+    if (!g_SdfCircles) {
+        return false;
+    }
+    GLint current = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &current);
+    return current == 0 && initSdf();
+}
+
+void appendSdfQuad(std::vector<float>& out, const SdfShape& s)
+{
+    static const float corners[4][2] = { { -1, -1 }, { 1, -1 }, { 1, 1 }, { -1, 1 } };
+    for (const float* c : corners) {
+        float v[SDF_FLOATS_PER_VERTEX] = {
+            c[0], c[1],
+            s.cx, s.cy, s.rx, s.ry,
+            s.inner, s.stroke, s.t1, s.t2,
+            s.r, s.g, s.b
+        };
+        out.insert(out.end(), v, v + SDF_FLOATS_PER_VERTEX);
+    }
+}
+
+// Units per pixel along the local x and y axes under the current matrices
+void sdfPixelSize(float size[2])
+{
+    GLfloat projection[16], modelview[16];
+    GLint viewport[4];
+    glGetFloatv(GL_PROJECTION_MATRIX, projection);
+    glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    for (int axis = 0; axis < 2; axis++) {
+        const GLfloat* column = modelview + 4 * axis;
+        float sx = (projection[0] * column[0] + projection[4] * column[1]) * 0.5f * viewport[2];
+        float sy = (projection[1] * column[0] + projection[5] * column[1]) * 0.5f * viewport[3];
+        float pixelsPerUnit = sqrtf(sx * sx + sy * sy);
+        size[axis] = pixelsPerUnit > 0.0f ? 1.0f / pixelsPerUnit : 1.0f;
+    }
+}
+
+// Draw quads from SdfShape vertices, at base in client memory or, with
+// base == NULL, in the currently bound GL_ARRAY_BUFFER
+void drawSdfArrays(const float* base, GLint first, GLsizei count)
+{
+    if (!initSdf()) {
+        return;
+    }
+    GLsizei stride = SDF_FLOATS_PER_VERTEX * sizeof(float);
+    glPushAttrib(GL_COLOR_BUFFER_BIT);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glUseProgram(g_SdfProgram);
+    float pixelSize[2];
+    sdfPixelSize(pixelSize);
+    glUniform2f(g_SdfPixelSizeLocation, pixelSize[0], pixelSize[1]);
+
+    const int sizes[4] = { 2, 4, 4, 3 };
+    int offset = 0;
+    for (GLuint i = 0; i < 4; i++) {
+        glEnableVertexAttribArray(i);
+        glVertexAttribPointer(i, sizes[i], GL_FLOAT, GL_FALSE, stride, (const char*)base + offset * sizeof(float));
+        offset += sizes[i];
+    }
+    glDrawArrays(GL_QUADS, first, count);
+    for (GLuint i = 0; i < 4; i++) {
+        glDisableVertexAttribArray(i);
+    }
+
+    glUseProgram(0);
+    glPopAttrib();
+}
+
+void drawSdfShape(const SdfShape& shape)
+{
+    static std::vector<float> vertices;
+    vertices.clear();
+    appendSdfQuad(vertices, shape);
+    drawSdfArrays(vertices.data(), 0, 4);
+}
+
+// Filled (stroke == 0) or outlined ellipse, optionally limited to [t1, t2]
+// and hollowed to a ring with inner = inner radius / outer radius
+void drawSdfEllipse(float cx, float cy, float rx, float ry, const float* RGB,
+    float stroke, float t1, float t2, float inner)
+{
+    SdfShape shape = { cx, cy, rx, ry, inner, stroke, t1, t2, RGB[0], RGB[1], RGB[2] };
+    drawSdfShape(shape);
+}
+#endif // SCENE_MODULE
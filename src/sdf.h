@@ -0,0 +1,30 @@
+#pragma once
+
+#include <GL/glut.h>
+#include <cmath>
+#include <vector>
+
+// What the scenes use of sdf.cpp. A scene module (scenemodule.cpp) only
+// includes this: the shader, and whether SDF circles are on, are the host's.
+
+// Tessellated "circles" with fewer segments than this are drawn as the
+// polygons they are
+const int SDF_MIN_SEGMENTS = 32;
+
+typedef struct {
+    float cx, cy; // Center
+    float rx, ry; // Outer radii
+    float inner; // Inner radius as a fraction of the outer one, 0 for a disk
+    float stroke; // Outline width in pixels, 0 to fill
+    float t1, t2; // Arc limits (ellipse parameter angle)
+    float r, g, b;
+} SdfShape;
+
+const int SDF_FLOATS_PER_VERTEX = 13; // corner(2) shape(4) params(4) color(3)
+
+bool sdfAvailable();
+void appendSdfQuad(std::vector<float>& out, const SdfShape& s);
+void drawSdfArrays(const float* base, GLint first, GLsizei count);
+void drawSdfShape(const SdfShape& shape);
+void drawSdfEllipse(float cx, float cy, float rx, float ry, const float* RGB,
+    float stroke = 0.0f, float t1 = 0.0f, float t2 = 2.0f * (float)M_PI, float inner = 0.0f);
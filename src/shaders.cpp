@@ -0,0 +1,84 @@
+#pragma once
+
+#include <GL/glut.h>
+#include <iostream>
+#include <vector>
+
+// Compile a single shader stage, printing the info log on failure. Returns 0 on error.
+GLuint compileShader(GLenum type, const char* source)
+{
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+
+    GLint ok = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        GLint length = 0;
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length + 1, '\0');
+        glGetShaderInfoLog(shader, length, NULL, log.data());
+        std::cerr << "ERROR: Shader compilation failed" << std::endl;
+        std::cerr << log.data() << std::endl;
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+// Link a program from any set of stages (vertex, tessellation, geometry,
+// fragment...). Returns 0 on error.
+GLuint buildShaderStages(const GLenum* types, const char* const* sources, int count)
+{
+    GLuint program = glCreateProgram();
+    std::vector<GLuint> stages;
+
+    for (int i = 0; i < count; i++) {
+        GLuint stage = compileShader(types[i], sources[i]);
+        if (!stage) {
+            for (GLuint compiled : stages)
+                glDeleteShader(compiled);
+            glDeleteProgram(program);
+            return 0;
+        }
+        glAttachShader(program, stage);
+        stages.push_back(stage);
+    }
+
+    glLinkProgram(program);
+    for (GLuint stage : stages) {
+        glDeleteShader(stage);
+    }
+
+    GLint ok = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        GLint length = 0;
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length + 1, '\0');
+        glGetProgramInfoLog(program, length, NULL, log.data());
+        std::cerr << "ERROR: Shader program link failed" << std::endl;
+        std::cerr << log.data() << std::endl;
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+// Link a program from vertex + fragment sources. Either stage may be NULL, in
+// which case the fixed-function pipeline handles it (compatibility profile).
+GLuint buildShaderProgram(const char* vertexSource, const char* fragmentSource)
+{
+    GLenum types[2];
+    const char* sources[2];
+    int count = 0;
+    if (vertexSource) {
+        types[count] = GL_VERTEX_SHADER;
+        sources[count++] = vertexSource;
+    }
+    if (fragmentSource) {
+        types[count] = GL_FRAGMENT_SHADER;
+        sources[count++] = fragmentSource;
+    }
+    return buildShaderStages(types, sources, count);
+}
@@ -0,0 +1,1041 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "headless.cpp"
+
+// SOFTWARE MODE
+// ./build/<scene> --headless [WIDTHxHEIGHT] --soft [--threads N] [--fill fan|nonzero|evenodd]
+//     [--aa none|analytic|ssaa4|ssaa16] ...
+// draw() rasterizes on the CPU into an RGBA8 canvas instead of calling
+// OpenGL: polygons with a scanline fill (optionally anti-aliased), wide lines with analytic coverage
+// (like GL_LINE_SMOOTH) and square points. Polygons are filled like GL_POLYGON
+// by default (--fill fan); nonzero and evenodd fill the exact outline instead. Transforms come from a CPU matrix
+// stack, and blending is GL_SRC_ALPHA / GL_ONE_MINUS_SRC_ALPHA as in display().
+// The output only depends on the input, so it can be compared across machines.
+// --out "" skips the PNG (useful for timing very large canvases).
+bool g_SoftMode = false;
+
+typedef enum {
+    SOFT_POLYGON,
+    SOFT_LINE_STRIP,
+    SOFT_POINTS
+} SoftPrimitive;
+
+// SOFT_FAN is the union of the triangle fan from the first vertex, which is
+// what GL_POLYGON draws for a concave outline on Mesa. Several scenes rely on
+// it: neighbouring concave figures leave 1 px gaps between their exact
+// outlines that the fan triangles cover.
+typedef enum {
+    SOFT_FAN,
+    SOFT_NON_ZERO,
+    SOFT_EVEN_ODD
+} SoftFillRule;
+
+SoftFillRule g_SoftFillRule = SOFT_FAN;
+const char* SOFT_FILL_NAMES[] = { "fan", "nonzero", "evenodd" };
+
+// 2D affine transform: x' = a*x + c*y + e, y' = b*x + d*y + f
+typedef struct {
+    float a, b, c, d, e, f;
+} SoftMatrix;
+
+// Pixels are R, G, B, A bytes (R in the low byte of each little-endian
+// uint32_t), bottom row first as glReadPixels returns them
+typedef struct {
+    int width;
+    int height;
+    std::vector<uint32_t> pixels;
+} SoftCanvas;
+
+// Pixel rectangle [x0, x1) x [y0, y1) that rasterization is limited to
+typedef struct {
+    int x0, y0, x1, y1;
+} SoftClip;
+
+SoftCanvas g_SoftCanvas = {};
+SoftMatrix g_SoftProjection = { 1, 0, 0, 1, 0, 0 }; // World -> pixels
+std::vector<SoftMatrix> g_SoftStack(1, SoftMatrix { 1, 0, 0, 1, 0, 0 });
+
+// --- Matrix stack ---
+
+SoftMatrix softMultiply(const SoftMatrix& m, const SoftMatrix& n)
+{
+    return {
+        m.a * n.a + m.c * n.b,
+        m.b * n.a + m.d * n.b,
+        m.a * n.c + m.c * n.d,
+        m.b * n.c + m.d * n.d,
+        m.a * n.e + m.c * n.f + m.e,
+        m.b * n.e + m.d * n.f + m.f
+    };
+}
+
+void softLoadIdentity()
+{
+    g_SoftStack.assign(1, SoftMatrix { 1, 0, 0, 1, 0, 0 });
+}
+
+void softPushMatrix()
+{
+    g_SoftStack.push_back(g_SoftStack.back());
+}
+
+void softPopMatrix()
+{
+    if (g_SoftStack.size() > 1) {
+        g_SoftStack.pop_back();
+    }
+}
+
+void softTranslate(float x, float y)
+{
+    g_SoftStack.back() = softMultiply(g_SoftStack.back(), { 1, 0, 0, 1, x, y });
+}
+
+void softRotate(float degrees)
+{
+    float t = degrees * (float)M_PI / 180.0f;
+    float c = cosf(t), s = sinf(t);
+    g_SoftStack.back() = softMultiply(g_SoftStack.back(), { c, s, -s, c, 0, 0 });
+}
+
+void softScale(float x, float y)
+{
+    g_SoftStack.back() = softMultiply(g_SoftStack.back(), { x, 0, 0, y, 0, 0 });
+}
+
+// Same mapping as gluOrtho2D + a full-canvas glViewport
+void softOrtho2D(float left, float right, float bottom, float top)
+{
+    float sx = g_SoftCanvas.width / (right - left);
+    float sy = g_SoftCanvas.height / (top - bottom);
+    g_SoftProjection = { sx, 0, 0, sy, -left * sx, -bottom * sy };
+}
+
+// --- Pixel operations ---
+
+inline uint32_t softPackColor(float r, float g, float b, float a)
+{
+    uint32_t R = (uint32_t)lroundf(std::min(std::max(r, 0.0f), 1.0f) * 255.0f);
+    uint32_t G = (uint32_t)lroundf(std::min(std::max(g, 0.0f), 1.0f) * 255.0f);
+    uint32_t B = (uint32_t)lroundf(std::min(std::max(b, 0.0f), 1.0f) * 255.0f);
+    uint32_t A = (uint32_t)lroundf(std::min(std::max(a, 0.0f), 1.0f) * 255.0f);
+    return R | (G << 8) | (B << 16) | (A << 24);
+}
+
+// Exact round(x / 255) for x <= 65535 - 128
+inline uint32_t softDiv255(uint32_t x)
+{
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+// dst = src * alpha + dst * (1 - alpha), per channel, alpha in 0..255
+inline uint32_t softBlendPixel(uint32_t dst, uint32_t src, uint32_t alpha)
+{
+    uint32_t result = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        uint32_t s = (src >> shift) & 0xFF;
+        uint32_t d = (dst >> shift) & 0xFF;
+        result |= softDiv255(s * alpha + d * (255 - alpha)) << shift;
+    }
+    return result;
+}
+
+void softFillSpan(uint32_t* dst, int n, uint32_t color)
+{
+    int i = 0;
+#ifdef __SSE2__
+    __m128i c = _mm_set1_epi32((int)color);
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_si128((__m128i*)(dst + i), c);
+    }
+#endif
+    for (; i < n; i++) {
+        dst[i] = color;
+    }
+}
+
+// Constant-alpha blend of a span; bit-identical to softBlendPixel
+void softBlendSpan(uint32_t* dst, int n, uint32_t color, uint32_t alpha)
+{
+    if (alpha == 0) {
+        return;
+    }
+    if (alpha == 255) {
+        softFillSpan(dst, n, color);
+        return;
+    }
+    int i = 0;
+#ifdef __SSE2__
+    __m128i zero = _mm_setzero_si128();
+    __m128i src = _mm_unpacklo_epi8(_mm_set1_epi32((int)color), zero);
+    __m128i srcTerm = _mm_add_epi16(_mm_mullo_epi16(src, _mm_set1_epi16((short)alpha)), _mm_set1_epi16(128));
+    __m128i inverse = _mm_set1_epi16((short)(255 - alpha));
+    for (; i + 4 <= n; i += 4) {
+        __m128i d = _mm_loadu_si128((__m128i*)(dst + i));
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), inverse), srcTerm);
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), inverse), srcTerm);
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (; i < n; i++) {
+        dst[i] = softBlendPixel(dst[i], color, alpha);
+    }
+}
+
+// --- Rasterization (vertices already in pixel coordinates) ---
+
+typedef struct {
+    float x0, y0, x1, y1;
+    int winding;
+} SoftEdge;
+
+// Edges of a closed polygon, sorted by their lower end, plus its y range
+void softBuildEdges(const float* xy, size_t n, std::vector<SoftEdge>& edges, float& minY, float& maxY)
+{
+    edges.clear();
+    minY = maxY = n ? xy[1] : 0.0f;
+    for (size_t i = 0; i < n; i++) {
+        size_t j = (i + 1) % n;
+        float x0 = xy[2 * i], y0 = xy[2 * i + 1];
+        float x1 = xy[2 * j], y1 = xy[2 * j + 1];
+        minY = std::min(minY, y0);
+        maxY = std::max(maxY, y0);
+        if (y0 == y1) {
+            continue;
+        }
+        if (y0 < y1) {
+            edges.push_back({ x0, y0, x1, y1, 1 });
+        } else {
+            edges.push_back({ x1, y1, x0, y0, -1 });
+        }
+    }
+    std::sort(edges.begin(), edges.end(), [](const SoftEdge& p, const SoftEdge& q) { return p.y0 < q.y0; });
+}
+
+// Edges whose non-zero fill is the union of the fan triangles (v0, vi, vi+1).
+// Each triangle is turned counter-clockwise, so windings only add up. The
+// spoke v0 -> vi is shared by two triangles and cancels unless the fan
+// changes direction there, so a convex polygon gets just its outline.
+void softBuildFanEdges(const float* xy, size_t n, std::vector<SoftEdge>& edges, float& minY, float& maxY)
+{
+    edges.clear();
+    minY = maxY = n ? xy[1] : 0.0f;
+    for (size_t i = 0; i < n; i++) {
+        minY = std::min(minY, xy[2 * i + 1]);
+        maxY = std::max(maxY, xy[2 * i + 1]);
+    }
+    auto add = [&](size_t i, size_t j, int weight) {
+        float x0 = xy[2 * i], y0 = xy[2 * i + 1];
+        float x1 = xy[2 * j], y1 = xy[2 * j + 1];
+        if (weight == 0 || y0 == y1) {
+            return;
+        }
+        if (y0 < y1) {
+            edges.push_back({ x0, y0, x1, y1, weight });
+        } else {
+            edges.push_back({ x1, y1, x0, y0, -weight });
+        }
+    };
+    // +1 or -1 so that every triangle winds the same way, 0 if degenerate
+    auto orientation = [&](size_t i) {
+        float ax = xy[2 * i] - xy[0], ay = xy[2 * i + 1] - xy[1];
+        float bx = xy[2 * i + 2] - xy[0], by = xy[2 * i + 3] - xy[1];
+        float cross = ax * by - ay * bx;
+        return cross > 0.0f ? -1 : (cross < 0.0f ? 1 : 0);
+    };
+    int previous = 0;
+    for (size_t i = 1; i + 1 < n; i++) {
+        int current = orientation(i);
+        add(0, i, current - previous);
+        add(i, i + 1, current);
+        previous = current;
+    }
+    if (n > 2) {
+        add(n - 1, 0, previous);
+    }
+    std::sort(edges.begin(), edges.end(), [](const SoftEdge& p, const SoftEdge& q) { return p.y0 < q.y0; });
+}
+
+// Scanline fill sampling pixel centers, so shared edges are not drawn twice.
+// Only pixels inside clip are touched, so tiles can be filled independently.
+void softFillEdges(SoftCanvas& canvas, const SoftClip& clip, const SoftEdge* edges, size_t n,
+    float minY, float maxY, uint32_t color, uint32_t alpha, SoftFillRule rule)
+{
+    thread_local std::vector<std::pair<float, int>> crossings;
+    thread_local std::vector<const SoftEdge*> active;
+    active.clear();
+
+    int yStart = std::max(clip.y0, (int)ceilf(minY - 0.5f));
+    int yEnd = std::min(clip.y1, (int)ceilf(maxY - 0.5f));
+    size_t firstPending = 0;
+
+    for (int y = yStart; y < yEnd; y++) {
+        float yc = y + 0.5f;
+        while (firstPending < n && edges[firstPending].y0 <= yc) {
+            active.push_back(&edges[firstPending++]);
+        }
+        crossings.clear();
+        for (size_t i = 0; i < active.size();) {
+            const SoftEdge* e = active[i];
+            if (e->y1 <= yc) {
+                active[i] = active.back();
+                active.pop_back();
+                continue;
+            }
+            float t = (yc - e->y0) / (e->y1 - e->y0);
+            crossings.push_back({ e->x0 + t * (e->x1 - e->x0), e->winding });
+            i++;
+        }
+        std::sort(crossings.begin(), crossings.end());
+
+        uint32_t* row = canvas.pixels.data() + (size_t)y * canvas.width;
+        int inside = 0;
+        for (size_t i = 0; i + 1 < crossings.size(); i++) {
+            inside += rule == SOFT_EVEN_ODD ? 1 : crossings[i].second;
+            bool filled = rule == SOFT_EVEN_ODD ? (inside & 1) != 0 : inside != 0;
+            if (!filled) {
+                continue;
+            }
+            int xa = std::max(clip.x0, (int)ceilf(crossings[i].first - 0.5f));
+            int xb = std::min(clip.x1, (int)ceilf(crossings[i + 1].first - 0.5f));
+            if (xb > xa) {
+                softBlendSpan(row + xa, xb - xa, color, alpha);
+            }
+        }
+    }
+}
+
+// --- Anti-aliased fills ---
+
+typedef enum {
+    SOFT_AA_NONE,
+    SOFT_AA_ANALYTIC, // Exact area coverage, one pass
+    SOFT_AA_SSAA4, // 2x2 samples per pixel, for comparison
+    SOFT_AA_SSAA16 // 4x4 samples per pixel, for comparison
+} SoftAntialias;
+
+SoftAntialias g_SoftAntialias = SOFT_AA_NONE;
+const char* SOFT_AA_NAMES[] = { "none", "analytic", "ssaa4", "ssaa16" };
+int g_SoftThreads = 1; // Counting the calling thread
+
+// --fill, --aa and --threads; only used with --headless --soft
+void parseSoftArgs(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--fill") == 0 && i + 1 < argc) {
+            i++;
+            for (int r = 0; r < 3; r++) {
+                if (strcmp(argv[i], SOFT_FILL_NAMES[r]) == 0) {
+                    g_SoftFillRule = (SoftFillRule)r;
+                }
+            }
+        } else if (strcmp(argv[i], "--aa") == 0 && i + 1 < argc) {
+            i++;
+            for (int m = 0; m < 4; m++) {
+                if (strcmp(argv[i], SOFT_AA_NAMES[m]) == 0) {
+                    g_SoftAntialias = (SoftAntialias)m;
+                }
+            }
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            g_SoftThreads = std::max(1, atoi(argv[++i]));
+        }
+    }
+}
+
+// Coverage in [0, 1] from an accumulated winding value
+inline float softCoverage(float winding, SoftFillRule rule)
+{
+    float a = fabsf(winding);
+    if (rule == SOFT_EVEN_ODD) {
+        a = fmodf(a, 2.0f);
+        return a > 1.0f ? 2.0f - a : a;
+    }
+    return std::min(a, 1.0f);
+}
+
+// Blend one row of per-pixel coverage (0..1) with the fill color
+void softBlendCoverage(uint32_t* dst, const float* coverage, int n, uint32_t color)
+{
+    for (int x = 0; x < n; x++) {
+        uint32_t alpha = (uint32_t)(coverage[x] * 255.0f + 0.5f);
+        if (alpha >= 255) {
+            dst[x] = color;
+        } else if (alpha) {
+            dst[x] = softBlendPixel(dst[x], color, alpha);
+        }
+    }
+}
+
+// In-place running sum
+void softPrefixSum(float* row, int n)
+{
+    int i = 0;
+    float total = 0.0f;
+#ifdef __SSE2__
+    __m128 carry = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4) {
+        __m128 x = _mm_loadu_ps(row + i);
+        x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 4)));
+        x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 8)));
+        x = _mm_add_ps(x, carry);
+        _mm_storeu_ps(row + i, x);
+        carry = _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    total = _mm_cvtss_f32(carry);
+#endif
+    for (; i < n; i++) {
+        total += row[i];
+        row[i] = total;
+    }
+}
+
+// Add the signed area of the segment to the accumulation rows. Every cell
+// receives the change in coverage from its left neighbour, so a running sum
+// along the row gives the coverage of each pixel. The segment must lie in
+// [0, width] x [0, height]; rows are stride = width + 2 cells long. weight
+// is the edge's winding.
+void softAccumulateLine(float* acc, int stride, float x0, float y0, float x1, float y1, float weight = 1.0f)
+{
+    if (y0 == y1) {
+        return;
+    }
+    float dir = weight;
+    if (y0 > y1) {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+        dir = -dir;
+    }
+    float dxdy = (x1 - x0) / (y1 - y0);
+    float x = x0;
+    for (int y = (int)y0; y < (int)ceilf(y1); y++) {
+        float* row = acc + (size_t)y * stride;
+        float dy = std::min((float)(y + 1), y1) - std::max((float)y, y0);
+        float xnext = x + dxdy * dy;
+        float d = dy * dir;
+        float xa = std::min(x, xnext), xb = std::max(x, xnext);
+        float xaFloor = floorf(xa);
+        int xai = (int)xaFloor;
+        int xbi = (int)ceilf(xb);
+        if (xbi <= xai + 1) {
+            // Stays inside one pixel column
+            float xmf = 0.5f * (x + xnext) - xaFloor;
+            row[xai] += d - d * xmf;
+            row[xai + 1] += d * xmf;
+        } else {
+            float s = 1.0f / (xb - xa);
+            float xaf = xa - xaFloor;
+            float a0 = 0.5f * s * (1.0f - xaf) * (1.0f - xaf);
+            float xbf = xb - xbi + 1.0f;
+            float am = 0.5f * s * xbf * xbf;
+            row[xai] += d * a0;
+            if (xbi == xai + 2) {
+                row[xai + 1] += d * (1.0f - a0 - am);
+            } else {
+                float a1 = s * (1.5f - xaf);
+                row[xai + 1] += d * (a1 - a0);
+                for (int xi = xai + 2; xi < xbi - 1; xi++) {
+                    row[xi] += d * s;
+                }
+                float a2 = a1 + (xbi - xai - 3) * s;
+                row[xbi - 1] += d * (1.0f - a2 - am);
+            }
+            row[xbi] += d * am;
+        }
+        x = xnext;
+    }
+}
+
+// Exact-area anti-aliased fill inside clip. Edge parts left of the clip are
+// moved onto its left side, which keeps their contribution to the pixels
+// inside; parts right of it cannot affect them and are dropped.
+void softFillEdgesAnalytic(SoftCanvas& canvas, const SoftClip& clip, const SoftEdge* edges, size_t n,
+    float minY, float maxY, uint32_t color, SoftFillRule rule)
+{
+    int width = clip.x1 - clip.x0;
+    int height = clip.y1 - clip.y0;
+    int stride = width + 2;
+    float top = std::min((float)height, maxY - clip.y0);
+    float bottom = std::max(0.0f, minY - clip.y0);
+    if (top <= bottom) {
+        return;
+    }
+    int rowStart = (int)bottom;
+    int rowEnd = (int)ceilf(top);
+
+    thread_local std::vector<float> acc;
+    acc.assign((size_t)stride * height, 0.0f);
+
+    for (size_t i = 0; i < n; i++) {
+        const SoftEdge& e = edges[i];
+        float ya = e.y0 - clip.y0, yb = e.y1 - clip.y0;
+        if (yb <= 0.0f || ya >= height) {
+            continue;
+        }
+        float xa = e.x0 - clip.x0, xb = e.x1 - clip.x0;
+        float dxdy = (xb - xa) / (yb - ya);
+        if (ya < 0.0f) {
+            xa -= ya * dxdy;
+            ya = 0.0f;
+        }
+        if (yb > height) {
+            xb -= (yb - height) * dxdy;
+            yb = (float)height;
+        }
+        if (ya >= yb) {
+            continue;
+        }
+
+        // Split where the edge crosses x = 0 and x = width
+        float ts[4] = { 0.0f, 1.0f, 1.0f, 1.0f };
+        int cuts = 1;
+        for (float boundary : { 0.0f, (float)width }) {
+            float t = (boundary - xa) / (xb - xa);
+            if (xa != xb && t > 0.0f && t < 1.0f) {
+                ts[cuts++] = t;
+            }
+        }
+        ts[cuts] = 1.0f;
+        std::sort(ts + 1, ts + cuts);
+        for (int k = 0; k < cuts; k++) {
+            float t0 = ts[k], t1 = ts[k + 1];
+            float px0 = xa + t0 * (xb - xa), py0 = ya + t0 * (yb - ya);
+            float px1 = xa + t1 * (xb - xa), py1 = ya + t1 * (yb - ya);
+            if (0.5f * (px0 + px1) >= width) {
+                continue;
+            }
+            px0 = std::min(std::max(px0, 0.0f), (float)width);
+            px1 = std::min(std::max(px1, 0.0f), (float)width);
+            softAccumulateLine(acc.data(), stride, px0, py0, px1, py1, (float)e.winding);
+        }
+    }
+
+    for (int y = rowStart; y < rowEnd; y++) {
+        float* row = acc.data() + (size_t)y * stride;
+        softPrefixSum(row, width);
+        for (int x = 0; x < width; x++) {
+            row[x] = softCoverage(row[x], rule);
+        }
+        softBlendCoverage(canvas.pixels.data() + (size_t)(clip.y0 + y) * canvas.width + clip.x0, row, width, color);
+    }
+}
+
+// Supersampled fill: grid x grid samples per pixel, each tested with the
+// same center-sampling rule as softFillEdges
+void softFillEdgesSupersampled(SoftCanvas& canvas, const SoftClip& clip, const SoftEdge* edges, size_t n,
+    float minY, float maxY, uint32_t color, SoftFillRule rule, int grid)
+{
+    thread_local std::vector<std::pair<float, int>> crossings;
+    thread_local std::vector<const SoftEdge*> active;
+    thread_local std::vector<int> hits;
+    thread_local std::vector<float> coverage;
+    active.clear();
+    int width = clip.x1 - clip.x0;
+    hits.assign(width, 0);
+    coverage.resize(width);
+    float samples = (float)(grid * grid);
+
+    int yStart = std::max(clip.y0, (int)floorf(minY));
+    int yEnd = std::min(clip.y1, (int)ceilf(maxY));
+    size_t firstPending = 0;
+
+    for (int y = yStart; y < yEnd; y++) {
+        for (int sy = 0; sy < grid; sy++) {
+            float yc = y + (sy + 0.5f) / grid;
+            while (firstPending < n && edges[firstPending].y0 <= yc) {
+                active.push_back(&edges[firstPending++]);
+            }
+            crossings.clear();
+            for (size_t i = 0; i < active.size();) {
+                const SoftEdge* e = active[i];
+                if (e->y1 <= yc) {
+                    active[i] = active.back();
+                    active.pop_back();
+                    continue;
+                }
+                float t = (yc - e->y0) / (e->y1 - e->y0);
+                crossings.push_back({ e->x0 + t * (e->x1 - e->x0), e->winding });
+                i++;
+            }
+            std::sort(crossings.begin(), crossings.end());
+
+            int inside = 0;
+            for (size_t i = 0; i + 1 < crossings.size(); i++) {
+                inside += rule == SOFT_EVEN_ODD ? 1 : crossings[i].second;
+                bool filled = rule == SOFT_EVEN_ODD ? (inside & 1) != 0 : inside != 0;
+                if (!filled) {
+                    continue;
+                }
+                // Sample columns (x + (j + 0.5) / grid) inside the span
+                int sa = std::max(clip.x0 * grid, (int)ceilf(crossings[i].first * grid - 0.5f));
+                int sb = std::min(clip.x1 * grid, (int)ceilf(crossings[i + 1].first * grid - 0.5f));
+                for (int sample = sa; sample < sb; sample++) {
+                    hits[sample / grid - clip.x0]++;
+                }
+            }
+        }
+
+        for (int x = 0; x < width; x++) {
+            coverage[x] = hits[x] / samples;
+            hits[x] = 0;
+        }
+        softBlendCoverage(canvas.pixels.data() + (size_t)y * canvas.width + clip.x0, coverage.data(), width, color);
+    }
+}
+
+// Coverage of a segment of the given width with butt ends, kept as the
+// maximum over what is already in the clip-sized buffer. It falls off over
+// one pixel at the edges, like a smoothed GL line.
+void softLineCoverage(float* coverage, const SoftClip& clip, float x0, float y0, float x1, float y1, float width)
+{
+    float dx = x1 - x0, dy = y1 - y0;
+    float length = sqrtf(dx * dx + dy * dy);
+    if (length == 0.0f) {
+        return;
+    }
+    float ux = dx / length, uy = dy / length;
+    float half = std::max(width, 1.0f) * 0.5f;
+    float reach = half + 1.0f;
+
+    int xa = std::max(clip.x0, (int)floorf(std::min(x0, x1) - reach));
+    int xb = std::min(clip.x1, (int)ceilf(std::max(x0, x1) + reach));
+    int ya = std::max(clip.y0, (int)floorf(std::min(y0, y1) - reach));
+    int yb = std::min(clip.y1, (int)ceilf(std::max(y0, y1) + reach));
+    int stride = clip.x1 - clip.x0;
+
+    for (int y = ya; y < yb; y++) {
+        float* row = coverage + (size_t)(y - clip.y0) * stride - clip.x0;
+        float py = y + 0.5f - y0;
+        for (int x = xa; x < xb; x++) {
+            float px = x + 0.5f - x0;
+            float along = px * ux + py * uy;
+            float across = fabsf(px * uy - py * ux);
+            float c = std::min(half + 0.5f - across, 1.0f);
+            c = std::min(c, std::min(along + 0.5f, length - along + 0.5f));
+            row[x] = std::max(row[x], c);
+        }
+    }
+}
+
+// Whole GL_LINE_STRIP in one pass: every pixel is blended once with the
+// largest coverage of any segment, so the joints are not darker than the
+// rest of the line
+void softDrawLineStrip(SoftCanvas& canvas, const SoftClip& clip, const float* xy, size_t n,
+    float width, uint32_t color)
+{
+    float x0 = xy[0], x1 = xy[0], y0 = xy[1], y1 = xy[1];
+    for (size_t i = 1; i < n; i++) {
+        x0 = std::min(x0, xy[2 * i]);
+        x1 = std::max(x1, xy[2 * i]);
+        y0 = std::min(y0, xy[2 * i + 1]);
+        y1 = std::max(y1, xy[2 * i + 1]);
+    }
+    float reach = std::max(width, 1.0f) * 0.5f + 1.0f;
+    SoftClip area = {
+        std::max(clip.x0, (int)floorf(x0 - reach)),
+        std::max(clip.y0, (int)floorf(y0 - reach)),
+        std::min(clip.x1, (int)ceilf(x1 + reach)),
+        std::min(clip.y1, (int)ceilf(y1 + reach))
+    };
+    int w = area.x1 - area.x0, h = area.y1 - area.y0;
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    thread_local std::vector<float> coverage;
+    coverage.assign((size_t)w * h, 0.0f);
+    for (size_t i = 0; i + 1 < n; i++) {
+        softLineCoverage(coverage.data(), area, xy[2 * i], xy[2 * i + 1], xy[2 * i + 2], xy[2 * i + 3], width);
+    }
+    for (int y = 0; y < h; y++) {
+        softBlendCoverage(canvas.pixels.data() + (size_t)(area.y0 + y) * canvas.width + area.x0,
+            coverage.data() + (size_t)y * w, w, color);
+    }
+}
+
+// Square point of side size centered on (x, y), as non-smoothed GL_POINTS
+void softDrawPoint(SoftCanvas& canvas, const SoftClip& clip, float x, float y, float size,
+    uint32_t color, uint32_t alpha)
+{
+    float half = std::max(1.0f, roundf(size)) * 0.5f;
+    int xa = std::max(clip.x0, (int)ceilf(x - half - 0.5f));
+    int xb = std::min(clip.x1, (int)ceilf(x + half - 0.5f));
+    int ya = std::max(clip.y0, (int)ceilf(y - half - 0.5f));
+    int yb = std::min(clip.y1, (int)ceilf(y + half - 0.5f));
+    for (int py = ya; py < yb && xb > xa; py++) {
+        softBlendSpan(canvas.pixels.data() + (size_t)py * canvas.width + xa, xb - xa, color, alpha);
+    }
+}
+
+// --- Frame recording and tiled rasterization ---
+// softSubmit() only transforms and records. At the end of the frame every
+// command is binned into the 64x64 tiles its bounds touch, and the tiles are
+// rasterized in parallel, each one running its commands in submission order,
+// so the blending result is the same for any number of threads.
+
+const int SOFT_TILE = 64;
+
+typedef struct {
+    SoftPrimitive primitive;
+    float width;
+    uint32_t color;
+    size_t first, count; // Vertices in g_SoftVertices (pixel coordinates)
+    size_t firstEdge, edgeCount; // Polygons: edges in g_SoftEdges
+    float minY, maxY;
+} SoftCommand;
+
+std::vector<SoftCommand> g_SoftCommands;
+std::vector<float> g_SoftVertices;
+std::vector<SoftEdge> g_SoftEdges;
+std::vector<std::vector<uint32_t>> g_SoftTiles; // Command indices per tile
+int g_SoftTilesX = 0;
+int g_SoftTilesY = 0;
+
+// Pixel bounds a command can touch, clamped to the canvas
+SoftClip softCommandBounds(const SoftCommand& cmd)
+{
+    const float* xy = g_SoftVertices.data() + 2 * cmd.first;
+    float x0 = xy[0], x1 = xy[0], y0 = xy[1], y1 = xy[1];
+    for (size_t i = 1; i < cmd.count; i++) {
+        x0 = std::min(x0, xy[2 * i]);
+        x1 = std::max(x1, xy[2 * i]);
+        y0 = std::min(y0, xy[2 * i + 1]);
+        y1 = std::max(y1, xy[2 * i + 1]);
+    }
+    float reach = 1.0f;
+    if (cmd.primitive == SOFT_LINE_STRIP) {
+        reach = std::max(cmd.width, 1.0f) * 0.5f + 1.0f;
+    } else if (cmd.primitive == SOFT_POINTS) {
+        reach = std::max(1.0f, roundf(cmd.width)) * 0.5f + 1.0f;
+    }
+    SoftClip bounds = {
+        std::max(0, (int)floorf(x0 - reach)),
+        std::max(0, (int)floorf(y0 - reach)),
+        std::min(g_SoftCanvas.width, (int)ceilf(x1 + reach) + 1),
+        std::min(g_SoftCanvas.height, (int)ceilf(y1 + reach) + 1)
+    };
+    return bounds;
+}
+
+void softRasterCommand(const SoftCommand& cmd, const SoftClip& clip)
+{
+    SoftCanvas& canvas = g_SoftCanvas;
+    const float* xy = g_SoftVertices.data() + 2 * cmd.first;
+    switch (cmd.primitive) {
+    case SOFT_POLYGON:
+    {
+        const SoftEdge* edges = g_SoftEdges.data() + cmd.firstEdge;
+        if (g_SoftAntialias == SOFT_AA_ANALYTIC) {
+            softFillEdgesAnalytic(canvas, clip, edges, cmd.edgeCount, cmd.minY, cmd.maxY, cmd.color, g_SoftFillRule);
+        } else if (g_SoftAntialias == SOFT_AA_SSAA4 || g_SoftAntialias == SOFT_AA_SSAA16) {
+            softFillEdgesSupersampled(canvas, clip, edges, cmd.edgeCount, cmd.minY, cmd.maxY, cmd.color,
+                g_SoftFillRule, g_SoftAntialias == SOFT_AA_SSAA4 ? 2 : 4);
+        } else {
+            softFillEdges(canvas, clip, edges, cmd.edgeCount, cmd.minY, cmd.maxY, cmd.color, 255, g_SoftFillRule);
+        }
+        break;
+    }
+    case SOFT_LINE_STRIP:
+        softDrawLineStrip(canvas, clip, xy, cmd.count, cmd.width, cmd.color);
+        break;
+    case SOFT_POINTS:
+        for (size_t i = 0; i < cmd.count; i++) {
+            softDrawPoint(canvas, clip, xy[2 * i], xy[2 * i + 1], cmd.width, cmd.color, 255);
+        }
+        break;
+    }
+}
+
+void softRasterTile(int tile)
+{
+    int tx = tile % g_SoftTilesX, ty = tile / g_SoftTilesX;
+    SoftClip clip = {
+        tx * SOFT_TILE,
+        ty * SOFT_TILE,
+        std::min(g_SoftCanvas.width, (tx + 1) * SOFT_TILE),
+        std::min(g_SoftCanvas.height, (ty + 1) * SOFT_TILE)
+    };
+    for (uint32_t index : g_SoftTiles[tile]) {
+        softRasterCommand(g_SoftCommands[index], clip);
+    }
+}
+
+// Work-stealing pool. Each thread (the caller is thread 0) starts with an
+// equal run of consecutive tiles, a [begin, end) range packed in one atomic
+// word: the owner takes tiles from the front, and a thread whose range is
+// empty takes the back half of the fullest one. Both sides change a range
+// with one compare-and-swap, so a tile is only ever taken once.
+typedef struct {
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::unique_ptr<std::atomic<uint64_t>[]> ranges; // One per thread
+    std::atomic<int> steals; // This frame
+    int threads;
+    int generation;
+    int busy;
+    bool quit;
+} SoftPool;
+
+SoftPool g_SoftPool;
+
+inline uint64_t softPackRange(uint32_t begin, uint32_t end)
+{
+    return ((uint64_t)begin << 32) | end;
+}
+
+// Next tile from the front of the thread's own range, -1 when it is empty
+int softTakeTile(std::atomic<uint64_t>& range)
+{
+    uint64_t r = range.load();
+    while ((uint32_t)(r >> 32) < (uint32_t)r) {
+        if (range.compare_exchange_weak(r, r + ((uint64_t)1 << 32))) {
+            return (int)(r >> 32);
+        }
+    }
+    return -1;
+}
+
+// Moves the back half of the fullest other range into self's; false when
+// every range is empty
+bool softStealTiles(int self)
+{
+    while (true) {
+        int victim = -1;
+        uint32_t most = 0;
+        for (int t = 0; t < g_SoftPool.threads; t++) {
+            uint64_t r = g_SoftPool.ranges[t].load();
+            uint32_t left = (uint32_t)r - (uint32_t)(r >> 32);
+            if (t != self && (uint32_t)r > (uint32_t)(r >> 32) && left > most) {
+                victim = t;
+                most = left;
+            }
+        }
+        if (victim < 0) {
+            return false;
+        }
+        uint64_t r = g_SoftPool.ranges[victim].load();
+        uint32_t begin = (uint32_t)(r >> 32), end = (uint32_t)r;
+        if (begin >= end) {
+            continue;
+        }
+        uint32_t split = end - (end - begin + 1) / 2;
+        if (g_SoftPool.ranges[victim].compare_exchange_strong(r, softPackRange(begin, split))) {
+            // Nobody takes from an empty range, so a plain store is safe
+            g_SoftPool.ranges[self].store(softPackRange(split, end));
+            g_SoftPool.steals++;
+            return true;
+        }
+    }
+}
+
+void softDrainTiles(int self)
+{
+    do {
+        int tile;
+        while ((tile = softTakeTile(g_SoftPool.ranges[self])) >= 0) {
+            softRasterTile(tile);
+        }
+    } while (softStealTiles(self));
+}
+
+void softWorker(int self)
+{
+    int seen = 0;
+    std::unique_lock<std::mutex> lock(g_SoftPool.mutex);
+    while (true) {
+        g_SoftPool.wake.wait(lock, [&] { return g_SoftPool.quit || g_SoftPool.generation != seen; });
+        if (g_SoftPool.quit) {
+            return;
+        }
+        seen = g_SoftPool.generation;
+        lock.unlock();
+        softDrainTiles(self);
+        lock.lock();
+        if (--g_SoftPool.busy == 0) {
+            g_SoftPool.done.notify_one();
+        }
+    }
+}
+
+// threads counts the calling thread
+void softStartPool(int threads)
+{
+    g_SoftPool.quit = false;
+    g_SoftPool.generation = 0;
+    g_SoftPool.threads = threads;
+    g_SoftPool.ranges.reset(new std::atomic<uint64_t>[threads]);
+    for (int i = 1; i < threads; i++) {
+        g_SoftPool.workers.emplace_back(softWorker, i);
+    }
+}
+
+void softStopPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(g_SoftPool.mutex);
+        g_SoftPool.quit = true;
+    }
+    g_SoftPool.wake.notify_all();
+    for (std::thread& worker : g_SoftPool.workers) {
+        worker.join();
+    }
+    g_SoftPool.workers.clear();
+}
+
+void softBeginFrame()
+{
+    g_SoftCommands.clear();
+    g_SoftVertices.clear();
+    g_SoftEdges.clear();
+    softLoadIdentity();
+}
+
+// Bin the recorded commands and rasterize all tiles
+void softEndFrame()
+{
+    g_SoftTilesX = (g_SoftCanvas.width + SOFT_TILE - 1) / SOFT_TILE;
+    g_SoftTilesY = (g_SoftCanvas.height + SOFT_TILE - 1) / SOFT_TILE;
+    g_SoftTiles.resize((size_t)g_SoftTilesX * g_SoftTilesY);
+    for (std::vector<uint32_t>& tile : g_SoftTiles) {
+        tile.clear();
+    }
+    for (size_t i = 0; i < g_SoftCommands.size(); i++) {
+        SoftClip bounds = softCommandBounds(g_SoftCommands[i]);
+        for (int ty = bounds.y0 / SOFT_TILE; ty * SOFT_TILE < bounds.y1; ty++) {
+            for (int tx = bounds.x0 / SOFT_TILE; tx * SOFT_TILE < bounds.x1; tx++) {
+                g_SoftTiles[(size_t)ty * g_SoftTilesX + tx].push_back((uint32_t)i);
+            }
+        }
+    }
+
+    uint32_t tiles = (uint32_t)g_SoftTiles.size();
+    for (int t = 0; t < g_SoftPool.threads; t++) {
+        g_SoftPool.ranges[t] = softPackRange(tiles * t / g_SoftPool.threads, tiles * (t + 1) / g_SoftPool.threads);
+    }
+    g_SoftPool.steals = 0;
+    {
+        std::lock_guard<std::mutex> lock(g_SoftPool.mutex);
+        g_SoftPool.busy = (int)g_SoftPool.workers.size();
+        g_SoftPool.generation++;
+    }
+    g_SoftPool.wake.notify_all();
+    softDrainTiles(0);
+    std::unique_lock<std::mutex> lock(g_SoftPool.mutex);
+    g_SoftPool.done.wait(lock, [] { return g_SoftPool.busy == 0; });
+}
+
+// --- Draw entry point ---
+
+// Transform the figure with the current matrix and record it for the
+// frame. withOrigin prepends (0, 0), as AREAFIX does.
+void softSubmit(SoftPrimitive primitive, float width, float r, float g, float b,
+    const std::vector<float>& X, const std::vector<float>& Y, size_t n, bool withOrigin = false)
+{
+    SoftMatrix m = softMultiply(g_SoftProjection, g_SoftStack.back());
+    SoftCommand cmd;
+    cmd.primitive = primitive;
+    cmd.width = width;
+    cmd.color = softPackColor(r, g, b, 1.0f);
+    cmd.first = g_SoftVertices.size() / 2;
+    if (withOrigin) {
+        g_SoftVertices.push_back(m.e);
+        g_SoftVertices.push_back(m.f);
+    }
+    for (size_t i = 0; i < n; i++) {
+        g_SoftVertices.push_back(m.a * X[i] + m.c * Y[i] + m.e);
+        g_SoftVertices.push_back(m.b * X[i] + m.d * Y[i] + m.f);
+    }
+    cmd.count = g_SoftVertices.size() / 2 - cmd.first;
+    if (cmd.count == 0) {
+        return;
+    }
+
+    cmd.firstEdge = g_SoftEdges.size();
+    cmd.edgeCount = 0;
+    cmd.minY = cmd.maxY = 0.0f;
+    if (primitive == SOFT_POLYGON) {
+        thread_local std::vector<SoftEdge> edges;
+        if (g_SoftFillRule == SOFT_FAN) {
+            softBuildFanEdges(g_SoftVertices.data() + 2 * cmd.first, cmd.count, edges, cmd.minY, cmd.maxY);
+        } else {
+            softBuildEdges(g_SoftVertices.data() + 2 * cmd.first, cmd.count, edges, cmd.minY, cmd.maxY);
+        }
+        g_SoftEdges.insert(g_SoftEdges.end(), edges.begin(), edges.end());
+        cmd.edgeCount = edges.size();
+    }
+    g_SoftCommands.push_back(cmd);
+}
+
+// --- Driver ---
+
+// Render scene() on the CPU, viewing [-extent, extent] on the shorter axis
+// (the reshape() of the Figure programs), against a clear color
+int runSoftware(const HeadlessOptions& opts, void (*scene)(), float extent,
+    float r = 1.0f, float g = 1.0f, float b = 1.0f)
+{
+    g_Headless = true;
+    g_SoftMode = true;
+    g_SoftCanvas.width = opts.width;
+    g_SoftCanvas.height = opts.height;
+    g_SoftCanvas.pixels.resize((size_t)opts.width * opts.height);
+
+    float aspect = (float)opts.width / opts.height;
+    if (opts.width >= opts.height) {
+        softOrtho2D(-extent * aspect, extent * aspect, -extent, extent);
+    } else {
+        softOrtho2D(-extent, extent, -extent / aspect, extent / aspect);
+    }
+    uint32_t clearColor = softPackColor(r, g, b, 1.0f);
+    softStartPool(g_SoftThreads);
+
+    std::cout << "Software: " << opts.width << "x" << opts.height
+              << ", " << SOFT_FILL_NAMES[g_SoftFillRule] << " fill"
+              << ", aa " << SOFT_AA_NAMES[g_SoftAntialias]
+              << ", " << g_SoftThreads << " thread(s)" << std::endl;
+
+    std::vector<double> times(opts.frames);
+    for (int i = 0; i < opts.frames; i++) {
+        auto start = std::chrono::steady_clock::now();
+        softFillSpan(g_SoftCanvas.pixels.data(), (int)g_SoftCanvas.pixels.size(), clearColor);
+        softBeginFrame();
+        scene();
+        softEndFrame();
+        times[i] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    softStopPool();
+
+    size_t binned = 0;
+    for (const std::vector<uint32_t>& tile : g_SoftTiles) {
+        binned += tile.size();
+    }
+    std::cout << "Commands: " << g_SoftCommands.size() << "  tiles: " << g_SoftTiles.size()
+              << "  binned: " << binned << "  steals: " << g_SoftPool.steals << std::endl;
+
+    if (!opts.output.empty()) {
+        if (writePNG(opts.output.c_str(), opts.width, opts.height, (const unsigned char*)g_SoftCanvas.pixels.data())) {
+            std::cout << "Wrote " << opts.output << std::endl;
+        }
+    }
+    printFrameStats(times);
+    return EXIT_SUCCESS;
+}
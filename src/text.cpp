@@ -0,0 +1,206 @@
+#pragma once
+
+#include "text.h"
+
+// A scene module (scenemodule.cpp) uses the host's atlases
+#ifndef SCENE_MODULE
+
+#include <GL/glut.h>
+#include <cmath>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bitmapfonts.h"
+#include "headless.cpp"
+
+// ATLAS TEXT
+// glutBitmapCharacter() costs a glBitmap() call per glyph, and needs glutInit
+// (so no text in headless runs). Here each font is baked once into an alpha
+// texture, one glyph after another, and a string becomes a VBO of textured
+// quads laid out in pixels. Strings are cached by content, so an unchanged
+// label (score, help line) is a single draw call with no layout at all.
+// Pixels are the same as GLUT's: same bitmaps, integer positions, nearest
+// filtering.
+
+const int TEXT_FIRST_GLYPH = ' ';
+const int TEXT_GLYPH_COUNT = '~' - ' ' + 1;
+
+typedef struct {
+    int advance; // Also the bitmap width
+    float u0, u1; // Atlas columns; rows span the whole atlas
+} AtlasGlyph;
+
+typedef struct {
+    const BitmapFontData* data;
+    GLuint texture;
+    AtlasGlyph glyphs[TEXT_GLYPH_COUNT];
+} FontAtlas;
+
+typedef struct {
+    GLuint vbo;
+    GLsizei count; // Quad vertices: x, y, u, v
+    int width; // Pixels
+} TextRun;
+
+FontAtlas g_FontAtlases[TEXT_FONT_COUNT] = {
+    { &HELVETICA_12, 0, {} },
+    { &HELVETICA_18, 0, {} },
+};
+std::unordered_map<std::string, TextRun> g_TextRuns[TEXT_FONT_COUNT];
+const size_t TEXT_MAX_RUNS = 256; // Per font
+
+// Expand every glyph's bitmap into an alpha texture of height x (sum of widths)
+bool bakeFontAtlas(FontAtlas& atlas)
+{
+    if (atlas.texture) {
+        return true;
+    }
+    const BitmapFontData& font = *atlas.data;
+    const unsigned char* glyph = font.glyphs;
+    const unsigned char* bitmaps[TEXT_GLYPH_COUNT];
+    int width = 0;
+    for (int i = 0; i < TEXT_GLYPH_COUNT; i++) {
+        int w = glyph[0];
+        bitmaps[i] = glyph + 1;
+        atlas.glyphs[i].advance = w;
+        glyph += 1 + font.height * ((w + 7) / 8);
+        width += w + 1; // One empty column between glyphs
+    }
+
+    std::vector<unsigned char> texels((size_t)width * font.height, 0);
+    int x = 0;
+    for (int i = 0; i < TEXT_GLYPH_COUNT; i++) {
+        int w = atlas.glyphs[i].advance;
+        int stride = (w + 7) / 8;
+        for (int row = 0; row < font.height; row++) {
+            for (int col = 0; col < w; col++) {
+                if (bitmaps[i][row * stride + col / 8] & (0x80 >> (col % 8))) {
+                    texels[(size_t)row * width + x + col] = 255;
+                }
+            }
+        }
+        atlas.glyphs[i].u0 = (float)x / width;
+        atlas.glyphs[i].u1 = (float)(x + w) / width;
+        x += w + 1;
+    }
+
+    GLint alignment = 4;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glGenTextures(1, &atlas.texture);
+    glPushAttrib(GL_TEXTURE_BIT); // The binding the state cache (glstate.cpp) knows comes back
+    glBindTexture(GL_TEXTURE_2D, atlas.texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA8, width, font.height, 0, GL_ALPHA, GL_UNSIGNED_BYTE, texels.data());
+    glPopAttrib();
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+    return true;
+}
+
+void clearTextRuns(int font)
+{
+    for (auto& entry : g_TextRuns[font]) {
+        glDeleteBuffers(1, &entry.second.vbo);
+    }
+    g_TextRuns[font].clear();
+}
+
+// Quads for text with the pen starting at (0, 0), as glBitmap would place them
+const TextRun& textRun(int font, const std::string& text)
+{
+    auto found = g_TextRuns[font].find(text);
+    if (found != g_TextRuns[font].end()) {
+        return found->second;
+    }
+    if (g_TextRuns[font].size() >= TEXT_MAX_RUNS) {
+        clearTextRuns(font);
+    }
+
+    const FontAtlas& atlas = g_FontAtlases[font];
+    float y0 = (float)-atlas.data->yorig;
+    float y1 = y0 + atlas.data->height;
+    std::vector<float> vertices;
+    int pen = 0;
+    for (unsigned char c : text) {
+        if (c < TEXT_FIRST_GLYPH || c >= TEXT_FIRST_GLYPH + TEXT_GLYPH_COUNT) {
+            continue; // GLUT skips these too
+        }
+        const AtlasGlyph& g = atlas.glyphs[c - TEXT_FIRST_GLYPH];
+        float x0 = (float)(pen - atlas.data->xorig);
+        float x1 = x0 + g.advance;
+        float quad[16] = { x0, y0, g.u0, 0, x1, y0, g.u1, 0, x1, y1, g.u1, 1, x0, y1, g.u0, 1 };
+        vertices.insert(vertices.end(), quad, quad + 16);
+        pen += g.advance;
+    }
+
+    TextRun run;
+    run.count = (GLsizei)(vertices.size() / 4);
+    run.width = pen;
+    glGenBuffers(1, &run.vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, run.vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return g_TextRuns[font][text] = run;
+}
+
+// Draw text in the current color with the pen at (x, y) under the current
+// matrices, like glRasterPos2f(x, y) followed by glutBitmapCharacter() calls.
+// Returns the width in pixels.
+int drawAtlasText(int font, float x, float y, const std::string& text)
+{
+    if (g_CoreProfile || !bakeFontAtlas(g_FontAtlases[font])) {
+        return 0;
+    }
+    const TextRun& run = textRun(font, text);
+    if (run.count == 0) {
+        return run.width;
+    }
+
+    GLdouble modelview[16], projection[16];
+    GLint viewport[4];
+    glGetDoublev(GL_MODELVIEW_MATRIX, modelview);
+    glGetDoublev(GL_PROJECTION_MATRIX, projection);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    GLdouble windowX, windowY, windowZ;
+    gluProject(x, y, 0.0, modelview, projection, viewport, &windowX, &windowY, &windowZ);
+
+    // Pixel space over the viewport, pen snapped like the raster position
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    gluOrtho2D(0, viewport[2], 0, viewport[3]);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+    glTranslatef(floorf((float)windowX - viewport[0]), floorf((float)windowY - viewport[1]), 0.0f);
+
+    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_TEXTURE_BIT);
+    glEnable(GL_TEXTURE_2D);
+    glDisable(GL_BLEND);
+    glEnable(GL_ALPHA_TEST); // Glyph texels are either 0 or 255
+    glAlphaFunc(GL_GREATER, 0.5f);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+    glBindTexture(GL_TEXTURE_2D, g_FontAtlases[font].texture);
+
+    glBindBuffer(GL_ARRAY_BUFFER, run.vbo);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 4 * sizeof(float), (void*)0);
+    glTexCoordPointer(2, GL_FLOAT, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+    glDrawArrays(GL_QUADS, 0, run.count);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glPopAttrib();
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+    return run.width;
+}
+#endif // SCENE_MODULE
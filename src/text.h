@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string>
+
+// What the scenes use of text.cpp. A scene module (scenemodule.cpp) only
+// includes this: the font atlases and cached strings are the host's.
+
+enum TextFont {
+    TEXT_HELVETICA_12,
+    TEXT_HELVETICA_18,
+    TEXT_FONT_COUNT
+};
+
+int drawAtlasText(int font, float x, float y, const std::string& text);
@@ -0,0 +1,95 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "pathasset.cpp"
+#include "tracing.cpp"
+
+// BEZIER TRACER
+// ./build/trace <image.png> [--threshold 0-255] [--invert] [--tolerance PX]
+//               [--min-size PX] [--threads N] [--name PREFIX] [--out FILE.paths]
+// Fits the outlines of the image and prints them as std::vector<Point>
+// tables, like the editor in debug.cpp does when leaving Bezier mode, or
+// with --out writes them as PREFIX0, PREFIX1, ... to a path asset file
+// (pathasset.cpp) that a running scene picks up. Drawn with genBezier over
+// the same image as reference (loadTexture), they land on the outlines they
+// came from. Statistics go to stderr.
+
+int main(int argc, char* argv[])
+{
+    TraceOptions opts = defaultTraceOptions();
+    const char* filename = NULL;
+    std::string name = "contour";
+    const char* output = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            opts.threshold = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--invert") == 0) {
+            opts.invert = true;
+        } else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            opts.tolerance = std::max(0.01f, (float)atof(argv[++i]));
+        } else if (strcmp(argv[i], "--min-size") == 0 && i + 1 < argc) {
+            opts.minSize = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            opts.threads = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--name") == 0 && i + 1 < argc) {
+            name = argv[++i];
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else if (!filename) {
+            filename = argv[i];
+        }
+    }
+    if (!filename) {
+        std::cerr << "Usage: " << argv[0] << " <image.png> [--threshold 0-255] [--invert] [--tolerance PX]"
+                  << " [--min-size PX] [--threads N] [--name PREFIX] [--out FILE.paths]" << std::endl;
+        return 1;
+    }
+
+    int width, height, channels;
+    unsigned char* pixels = stbi_load(filename, &width, &height, &channels, 0);
+    if (!pixels) {
+        std::cerr << "ERROR: Could not load image '" << filename << "'" << std::endl;
+        std::cerr << "Reason: " << stbi_failure_reason() << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::vector<TracePoint>> paths = traceImage(pixels, width, height, channels, opts);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    stbi_image_free(pixels);
+
+    size_t segments = 0;
+    std::vector<NamedPath> assets;
+    for (size_t k = 0; k < paths.size(); k++) {
+        const std::vector<TracePoint>& path = paths[k];
+        segments += (path.size() - 1) / 2;
+        if (output) {
+            const float* xy = &path[0].x;
+            assets.push_back({ name + std::to_string(k), std::vector<float>(xy, xy + 2 * path.size()) });
+            continue;
+        }
+        std::cout << "std::vector<Point> " << name << k << " = {" << std::endl;
+        for (size_t i = 0; i < path.size(); ++i) {
+            std::cout << "    { " << path[i].x << "f, " << path[i].y << "f }";
+            if (i < path.size() - 1) {
+                std::cout << ",";
+            }
+            std::cout << std::endl;
+        }
+        std::cout << "};" << std::endl;
+    }
+    if (output && !writePathAssets(output, assets)) {
+        return 1;
+    }
+    std::cerr << "Traced " << filename << " (" << width << "x" << height << "): " << paths.size()
+              << " contours, " << segments << " quadratic segments in " << ms << " ms ("
+              << opts.threads << " threads, tolerance " << opts.tolerance << "px)" << std::endl;
+    return 0;
+}
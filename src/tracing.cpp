@@ -0,0 +1,529 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// CONTOUR TRACING
+// ./build/trace <image.png> (see trace.cpp)
+// Turns a bitmap into closed quadratic Bezier paths laid out like the
+// editor's output: P0, C, P1, C, P2, ..., back to P0, in the [-1, 1] square
+// that drawImageReference() covers, so they can go straight into genBezier.
+// Pixels darker than the threshold (lighter with invert, transparent ones
+// never) are ink. Marching squares over the pixel centers gives closed,
+// consistently oriented outlines with subpixel crossings interpolated from
+// the luminance. Each outline is cut at its corners and every run is fitted
+// with as few quadratics as the tolerance allows: least-squares control
+// point, Newton reparameterization, split at the worst point otherwise.
+// Joints between smooth pieces are then nudged onto the line between their
+// control points when that keeps the error in tolerance, so curves meet
+// without kinks. Cell classification runs in row bands and fitting runs per
+// contour, both on all cores.
+
+typedef struct {
+    float x, y;
+} TracePoint;
+
+typedef struct {
+    int threshold; // 0-255 luminance
+    bool invert; // Light ink on a dark background
+    float tolerance; // Max distance from the outline, in pixels
+    float minSize; // Contours with a smaller bounding box are noise, in pixels
+    int threads;
+} TraceOptions;
+
+TraceOptions defaultTraceOptions()
+{
+    TraceOptions opts;
+    opts.threshold = 128;
+    opts.invert = false;
+    opts.tolerance = 1.0f;
+    opts.minSize = 8.0f;
+    opts.threads = std::max(1u, std::thread::hardware_concurrency());
+    return opts;
+}
+
+// Run fn(0..count-1) on up to threads threads, indices handed out one by one
+void traceParallel(int count, int threads, const std::function<void(int)>& fn)
+{
+    std::atomic<int> next(0);
+    auto work = [&]() {
+        for (int i = next++; i < count; i = next++) {
+            fn(i);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int i = 1; i < std::min(threads, count); i++) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+// --- Marching squares ---
+
+typedef struct {
+    int64_t from, to; // Grid edges the segment starts and ends on
+    TracePoint start;
+} TraceSegment;
+
+// Signed ink field over the pixel centers plus a one-sample border of
+// background: positive inside, 0 at the threshold
+class TraceField {
+public:
+    int width, height; // Image size; the field is (width + 2) x (height + 2)
+    std::vector<float> values;
+
+    float at(int i, int j) const { return values[(size_t)j * (width + 2) + i]; }
+
+    // Sample (i, j) sits at pixel center (i - 0.5, j - 0.5)
+    int64_t horizontalEdge(int i, int j) const { return 2 * ((int64_t)j * (width + 2) + i); }
+    int64_t verticalEdge(int i, int j) const { return horizontalEdge(i, j) + 1; }
+
+    // Where the field crosses zero between samples (ai, aj) and (bi, bj)
+    TracePoint crossing(int ai, int aj, int bi, int bj) const
+    {
+        float a = at(ai, aj), b = at(bi, bj);
+        float t = a / (a - b);
+        TracePoint p;
+        p.x = std::min(std::max(ai - 0.5f + t * (bi - ai), 0.0f), (float)width);
+        p.y = std::min(std::max(aj - 0.5f + t * (bj - aj), 0.0f), (float)height);
+        return p;
+    }
+};
+
+TraceField buildTraceField(const unsigned char* pixels, int width, int height, int channels, const TraceOptions& opts)
+{
+    TraceField field;
+    field.width = width;
+    field.height = height;
+    field.values.assign((size_t)(width + 2) * (height + 2), -1.0f);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            const unsigned char* p = pixels + ((size_t)y * width + x) * channels;
+            float luminance = channels >= 3 ? 0.299f * p[0] + 0.587f * p[1] + 0.114f * p[2] : p[0];
+            bool opaque = channels == 4 ? p[3] >= 128 : channels == 2 ? p[1] >= 128 : true;
+            float value = opts.invert ? luminance - opts.threshold : opts.threshold - luminance;
+            if (value == 0.0f) {
+                value = -0.001f; // Exactly at the threshold counts as background
+            }
+            field.values[(size_t)(y + 1) * (width + 2) + x + 1] = opaque ? value : -1.0f;
+        }
+    }
+    return field;
+}
+
+// Segments of cell (i, j), whose corners are samples (i, j) to (i + 1, j + 1),
+// oriented so ink is on the right in image coordinates (y down), which is
+// counterclockwise once y points up
+void traceCell(const TraceField& field, int i, int j, std::vector<TraceSegment>& out)
+{
+    // Corners: top-left, top-right, bottom-right, bottom-left
+    const int ci[4] = { i, i + 1, i + 1, i };
+    const int cj[4] = { j, j, j + 1, j + 1 };
+    bool inside[4];
+    int count = 0;
+    for (int k = 0; k < 4; k++) {
+        inside[k] = field.at(ci[k], cj[k]) > 0.0f;
+        count += inside[k];
+    }
+    if (count == 0 || count == 4) {
+        return;
+    }
+
+    // Edge e joins corners e and e + 1 (clockwise): top, right, bottom,
+    // left. With ink on the right, a segment starts on the edge going from
+    // ink to background and ends on the one going back into ink.
+    int64_t ids[4] = { field.horizontalEdge(i, j), field.verticalEdge(i + 1, j),
+        field.horizontalEdge(i, j + 1), field.verticalEdge(i, j) };
+    auto emit = [&](int ea, int eb) {
+        if (!inside[ea]) {
+            std::swap(ea, eb);
+        }
+        TracePoint a = field.crossing(ci[ea], cj[ea], ci[(ea + 1) % 4], cj[(ea + 1) % 4]);
+        out.push_back({ ids[ea], ids[eb], a });
+    };
+
+    if (count == 2 && inside[0] == inside[2]) {
+        // Saddle: the cell center decides which pair of corners is joined
+        float center = 0.0f;
+        for (int k = 0; k < 4; k++) {
+            center += field.at(ci[k], cj[k]);
+        }
+        bool centerInside = center > 0.0f;
+        for (int k = 0; k < 4; k++) {
+            if (inside[k] != centerInside) {
+                emit((k + 3) % 4, k); // Edges around corner k
+            }
+        }
+        return;
+    }
+
+    int edges[2], found = 0;
+    for (int e = 0; e < 4; e++) {
+        if (inside[e] != inside[(e + 1) % 4]) {
+            edges[found++] = e;
+        }
+    }
+    emit(edges[0], edges[1]);
+}
+
+// Closed outlines in pixel coordinates (y down), one point per crossed edge
+std::vector<std::vector<TracePoint>> traceContours(const TraceField& field, const TraceOptions& opts)
+{
+    int rows = field.height + 1;
+    int bands = std::min(rows, opts.threads * 4);
+    std::vector<std::vector<TraceSegment>> banded(bands);
+    traceParallel(bands, opts.threads, [&](int band) {
+        int first = (int)((int64_t)rows * band / bands);
+        int last = (int)((int64_t)rows * (band + 1) / bands);
+        for (int j = first; j < last; j++) {
+            for (int i = 0; i <= field.width; i++) {
+                traceCell(field, i, j, banded[band]);
+            }
+        }
+    });
+
+    std::vector<TraceSegment> segments;
+    for (std::vector<TraceSegment>& band : banded) {
+        segments.insert(segments.end(), band.begin(), band.end());
+    }
+    // Segment starting on each grid edge, indexed directly by edge id
+    std::vector<int> starting(2 * (size_t)(field.width + 2) * (field.height + 2), -1);
+    for (size_t s = 0; s < segments.size(); s++) {
+        starting[segments[s].from] = (int)s;
+    }
+
+    // Every crossed edge starts one segment and ends another, so following
+    // them always closes a loop
+    std::vector<std::vector<TracePoint>> contours;
+    std::vector<bool> used(segments.size(), false);
+    for (size_t s = 0; s < segments.size(); s++) {
+        if (used[s]) {
+            continue;
+        }
+        std::vector<TracePoint> contour;
+        float minX = segments[s].start.x, maxX = minX, minY = segments[s].start.y, maxY = minY;
+        for (int k = (int)s; !used[k];) {
+            used[k] = true;
+            const TracePoint& p = segments[k].start;
+            contour.push_back(p);
+            minX = std::min(minX, p.x);
+            maxX = std::max(maxX, p.x);
+            minY = std::min(minY, p.y);
+            maxY = std::max(maxY, p.y);
+            k = starting[segments[k].to];
+            if (k < 0) {
+                break;
+            }
+        }
+        if (maxX - minX >= opts.minSize || maxY - minY >= opts.minSize) {
+            contours.push_back(contour);
+        }
+    }
+    return contours;
+}
+
+// --- Fitting ---
+
+typedef struct {
+    TracePoint p0, c, p1;
+    int first, last; // Outline points covered
+    bool smoothStart; // p0 is not a corner
+} TraceQuad;
+
+TracePoint quadAt(const TraceQuad& q, float t)
+{
+    float u = 1.0f - t;
+    return { u * u * q.p0.x + 2 * u * t * q.c.x + t * t * q.p1.x, u * u * q.p0.y + 2 * u * t * q.c.y + t * t * q.p1.y };
+}
+
+// One Newton step on the distance from the curve at t to p
+float refineParameter(const TraceQuad& q, float t, const TracePoint& p)
+{
+    TracePoint b = quadAt(q, t);
+    float u = 1.0f - t;
+    float dx = 2 * (u * (q.c.x - q.p0.x) + t * (q.p1.x - q.c.x));
+    float dy = 2 * (u * (q.c.y - q.p0.y) + t * (q.p1.y - q.c.y));
+    float ddx = 2 * (q.p1.x - 2 * q.c.x + q.p0.x);
+    float ddy = 2 * (q.p1.y - 2 * q.c.y + q.p0.y);
+    float ex = b.x - p.x, ey = b.y - p.y;
+    float numerator = ex * dx + ey * dy;
+    float denominator = dx * dx + dy * dy + ex * ddx + ey * ddy;
+    if (fabsf(denominator) < 1e-12f) {
+        return t;
+    }
+    return std::min(std::max(t - numerator / denominator, 0.0f), 1.0f);
+}
+
+// Chord-length parameters of pts[0..n-1]
+void chordParameters(const TracePoint* pts, int n, std::vector<float>& t)
+{
+    t.assign(n, 0.0f);
+    for (int i = 1; i < n; i++) {
+        t[i] = t[i - 1] + hypotf(pts[i].x - pts[i - 1].x, pts[i].y - pts[i - 1].y);
+    }
+    if (t[n - 1] > 0.0f) {
+        for (int i = 1; i < n; i++) {
+            t[i] /= t[n - 1];
+        }
+    }
+}
+
+// Largest distance from pts[0..n-1] to the curve; worst gets its index.
+// Infinite when the curve takes a detour between points (parameters out of
+// order, or much longer than the outline), which the distances alone miss.
+float quadError(const TraceQuad& q, const TracePoint* pts, int n, std::vector<float>& t, int* worst)
+{
+    float error = 0.0f, length = 0.0f;
+    for (int i = 0; i < n; i++) {
+        t[i] = refineParameter(q, refineParameter(q, t[i], pts[i]), pts[i]);
+        TracePoint b = quadAt(q, t[i]);
+        float d = hypotf(b.x - pts[i].x, b.y - pts[i].y);
+        if (d > error) {
+            error = d;
+            if (worst) {
+                *worst = i;
+            }
+        }
+        if (i > 0) {
+            length += hypotf(pts[i].x - pts[i - 1].x, pts[i].y - pts[i - 1].y);
+            if (t[i] < t[i - 1]) {
+                error = INFINITY;
+            }
+        }
+    }
+    float curveLength = 0.0f;
+    TracePoint a = q.p0;
+    for (int k = 1; k <= 16; k++) {
+        TracePoint b = quadAt(q, k / 16.0f);
+        curveLength += hypotf(b.x - a.x, b.y - a.y);
+        a = b;
+    }
+    if (curveLength > length * 1.2f + 2.0f) {
+        error = INFINITY;
+    }
+    return error;
+}
+
+// Control point minimizing the squared distances at parameters t, ends fixed
+TracePoint leastSquaresControl(const TracePoint* pts, int n, const std::vector<float>& t, TracePoint p0, TracePoint p1)
+{
+    float sx = 0.0f, sy = 0.0f, sw = 0.0f;
+    for (int i = 0; i < n; i++) {
+        float u = 1.0f - t[i];
+        float w = 2 * u * t[i];
+        sx += w * (pts[i].x - u * u * p0.x - t[i] * t[i] * p1.x);
+        sy += w * (pts[i].y - u * u * p0.y - t[i] * t[i] * p1.y);
+        sw += w * w;
+    }
+    if (sw < 1e-12f) {
+        return { (p0.x + p1.x) / 2, (p0.y + p1.y) / 2 };
+    }
+    return { sx / sw, sy / sw };
+}
+
+// Fit pts[first..last] (indices into the unrolled outline), appending quads
+void fitRun(const std::vector<TracePoint>& pts, int first, int last, float tolerance, std::vector<TraceQuad>& out)
+{
+    int n = last - first + 1;
+    const TracePoint* run = &pts[first];
+    TraceQuad q = { run[0], run[0], run[n - 1], first, last, true };
+    if (n <= 3) {
+        q.c = n == 3 ? run[1] : TracePoint { (run[0].x + run[n - 1].x) / 2, (run[0].y + run[n - 1].y) / 2 };
+        out.push_back(q);
+        return;
+    }
+
+    thread_local std::vector<float> t;
+    chordParameters(run, n, t);
+    int worst = n / 2;
+    float error = 0.0f;
+    for (int iteration = 0; iteration < 4; iteration++) {
+        q.c = leastSquaresControl(run, n, t, q.p0, q.p1);
+        error = quadError(q, run, n, t, &worst);
+        if (error <= tolerance) {
+            out.push_back(q);
+            return;
+        }
+        if (error > 4 * tolerance) {
+            break; // Reparameterizing will not get there, split right away
+        }
+    }
+    // Split at the worst point, kept off the ends so jagged runs still halve
+    worst = std::min(std::max(worst, n / 4), n - 1 - n / 4);
+    fitRun(pts, first, first + worst, tolerance, out);
+    fitRun(pts, first + worst, last, tolerance, out);
+}
+
+// Turning angle at each point, measured over about reach pixels of outline
+std::vector<int> findCorners(const std::vector<TracePoint>& pts, float reach, float minAngle)
+{
+    int n = (int)pts.size();
+    std::vector<float> angle(n, 0.0f);
+    for (int i = 0; i < n; i++) {
+        int a = i, b = i;
+        float back = 0.0f, ahead = 0.0f;
+        for (int k = 0; k < n / 2 && back < reach; k++) {
+            int prev = (a + n - 1) % n;
+            back += hypotf(pts[a].x - pts[prev].x, pts[a].y - pts[prev].y);
+            a = prev;
+        }
+        for (int k = 0; k < n / 2 && ahead < reach; k++) {
+            int next = (b + 1) % n;
+            ahead += hypotf(pts[next].x - pts[b].x, pts[next].y - pts[b].y);
+            b = next;
+        }
+        float ax = pts[i].x - pts[a].x, ay = pts[i].y - pts[a].y;
+        float bx = pts[b].x - pts[i].x, by = pts[b].y - pts[i].y;
+        angle[i] = fabsf(atan2f(ax * by - ay * bx, ax * bx + ay * by));
+    }
+
+    // Local maxima only, so a rounded corner gives one split
+    std::vector<int> corners;
+    int window = std::max(1, (int)(reach / 2));
+    for (int i = 0; i < n; i++) {
+        if (angle[i] < minAngle) {
+            continue;
+        }
+        bool peak = true;
+        for (int k = -window; k <= window && peak; k++) {
+            int j = (i + k + n) % n;
+            peak = angle[j] < angle[i] || (angle[j] == angle[i] && j >= i);
+        }
+        if (peak) {
+            corners.push_back(i);
+        }
+    }
+    return corners;
+}
+
+// Move each smooth joint onto the line between its neighbouring control
+// points when both curves stay within tolerance
+void smoothJoints(std::vector<TraceQuad>& quads, const std::vector<TracePoint>& pts, float tolerance)
+{
+    int count = (int)quads.size();
+    std::vector<float> t;
+    for (int k = 0; k < count; k++) {
+        TraceQuad& next = quads[k];
+        TraceQuad& prev = quads[(k + count - 1) % count];
+        if (!next.smoothStart || count < 2) {
+            continue;
+        }
+        float lx = next.c.x - prev.c.x, ly = next.c.y - prev.c.y;
+        float a = hypotf(next.p0.x - prev.c.x, next.p0.y - prev.c.y);
+        float b = hypotf(next.c.x - next.p0.x, next.c.y - next.p0.y);
+        if (a + b < 1e-6f) {
+            continue;
+        }
+        TracePoint joint = { prev.c.x + lx * a / (a + b), prev.c.y + ly * a / (a + b) };
+
+        TraceQuad candidatePrev = prev, candidateNext = next;
+        candidatePrev.p1 = joint;
+        candidateNext.p0 = joint;
+        bool fits = true;
+        for (const TraceQuad* q : { &candidatePrev, &candidateNext }) {
+            int n = q->last - q->first + 1;
+            chordParameters(&pts[q->first], n, t);
+            if (quadError(*q, &pts[q->first], n, t, NULL) > tolerance) {
+                fits = false;
+            }
+        }
+        if (fits) {
+            prev.p1 = joint;
+            next.p0 = joint;
+        }
+    }
+}
+
+// Quadratic pieces of one closed outline, in pixel coordinates
+std::vector<TraceQuad> fitContour(const std::vector<TracePoint>& contour, float tolerance)
+{
+    // Drop repeated points (crossings clamped onto the image border)
+    std::vector<TracePoint> pts;
+    for (const TracePoint& p : contour) {
+        if (pts.empty() || fabsf(p.x - pts.back().x) + fabsf(p.y - pts.back().y) > 1e-4f) {
+            pts.push_back(p);
+        }
+    }
+    while (pts.size() > 1 && fabsf(pts[0].x - pts.back().x) + fabsf(pts[0].y - pts.back().y) <= 1e-4f) {
+        pts.pop_back();
+    }
+    int n = (int)pts.size();
+    if (n < 3) {
+        return {};
+    }
+
+    // Start at a corner (or anywhere on a smooth loop) and unroll the loop
+    // once, so every run is a plain index range
+    std::vector<int> corners = findCorners(pts, 3.0f, 0.9f);
+    int start = corners.empty() ? 0 : corners[0];
+    std::vector<TracePoint> unrolled(n + 1);
+    std::vector<bool> isCorner(n + 1, false);
+    for (int i = 0; i <= n; i++) {
+        unrolled[i] = pts[(start + i) % n];
+    }
+    for (int c : corners) {
+        isCorner[(c - start + n) % n] = true;
+    }
+    isCorner[n] = isCorner[0];
+
+    // Runs end at corners; a smooth loop is halved, since a single
+    // quadratic can not close it
+    std::vector<int> ends;
+    for (int i = 1; i <= n; i++) {
+        if (isCorner[i] || i == n || (corners.empty() && i == n / 2)) {
+            ends.push_back(i);
+        }
+    }
+    std::vector<TraceQuad> quads;
+    int runStart = 0;
+    for (int end : ends) {
+        fitRun(unrolled, runStart, end, tolerance, quads);
+        runStart = end;
+    }
+    for (TraceQuad& q : quads) {
+        q.smoothStart = !isCorner[q.first];
+    }
+    smoothJoints(quads, unrolled, tolerance);
+    return quads;
+}
+
+// Bezier paths (P0, C, P1, ..., P0) for every ink outline in the image,
+// pixels given row by row from the top as stbi_load returns them
+std::vector<std::vector<TracePoint>> traceImage(const unsigned char* pixels, int width, int height, int channels, const TraceOptions& opts)
+{
+    TraceField field = buildTraceField(pixels, width, height, channels, opts);
+    std::vector<std::vector<TracePoint>> contours = traceContours(field, opts);
+
+    // Largest outlines first: they are the ones worth fitting first, and the
+    // order stays the same for any number of threads
+    std::sort(contours.begin(), contours.end(), [](const std::vector<TracePoint>& a, const std::vector<TracePoint>& b) {
+        return a.size() > b.size();
+    });
+
+    std::vector<std::vector<TracePoint>> paths(contours.size());
+    traceParallel((int)contours.size(), opts.threads, [&](int k) {
+        std::vector<TraceQuad> quads = fitContour(contours[k], opts.tolerance);
+        auto toWorld = [&](const TracePoint& p) {
+            return TracePoint { p.x / width * 2.0f - 1.0f, 1.0f - p.y / height * 2.0f };
+        };
+        std::vector<TracePoint>& path = paths[k];
+        for (const TraceQuad& q : quads) {
+            if (path.empty()) {
+                path.push_back(toWorld(q.p0));
+            }
+            path.push_back(toWorld(q.c));
+            path.push_back(toWorld(q.p1));
+        }
+    });
+    paths.erase(std::remove_if(paths.begin(), paths.end(), [](const std::vector<TracePoint>& path) { return path.size() < 3; }),
+        paths.end());
+    return paths;
+}